@@ -15,8 +15,32 @@ SOURCES += \
     ringbuffer.cpp \
     serialportworker.cpp \
     qcustomplot/qcustomplot.cpp \
-    waveformworker.cpp \
-    attitudeworker.cpp
+    attitudeworker.cpp \
+    logwriter.cpp \
+    decodeworker.cpp \
+    textclassifier.cpp \
+    linecollapser.cpp \
+    highlightrules.cpp \
+    extractrules.cpp \
+    extractworker.cpp \
+    numericscanner.cpp \
+    patternprefilter.cpp \
+    channelregistry.cpp \
+    binaryschema.cpp \
+    framedecodeworker.cpp \
+    builtindecoders.cpp \
+    derivedchannels.cpp \
+    watchpanel.cpp \
+    waveseries.cpp \
+    waveformview.cpp \
+    wavegraph.cpp \
+    samplearchive.cpp \
+    renderscheduler.cpp \
+    plottheme.cpp \
+    fftkernel.cpp \
+    spectrumworker.cpp \
+    spectrumview.cpp \
+    waterfallmap.cpp
 
 HEADERS += \
     mainwindow.h \
@@ -24,8 +48,34 @@ HEADERS += \
     ringbuffer.h \
     serialportworker.h \
     qcustomplot/qcustomplot.h \
-    waveformworker.h \
-    attitudeworker.h
+    attitudeworker.h \
+    logwriter.h \
+    decodeworker.h \
+    textclassifier.h \
+    linecollapser.h \
+    highlightrules.h \
+    extractrules.h \
+    extractworker.h \
+    numericscanner.h \
+    patternprefilter.h \
+    channelregistry.h \
+    binaryschema.h \
+    framedecodeworker.h \
+    packetdecoder.h \
+    fixedlayoutdecoder.h \
+    builtindecoders.h \
+    derivedchannels.h \
+    watchpanel.h \
+    waveseries.h \
+    waveformview.h \
+    wavegraph.h \
+    samplearchive.h \
+    renderscheduler.h \
+    plottheme.h \
+    fftkernel.h \
+    spectrumworker.h \
+    spectrumview.h \
+    waterfallmap.h
 
 FORMS += \
     mainwindow.ui
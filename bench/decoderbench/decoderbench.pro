@@ -0,0 +1,19 @@
+# 解码基准：同一段 imu6 帧流分别经 SchemaDecoder（解释执行）与内置 FixedLayout 解码器，
+# 比较每帧耗时。用 release 构建：qmake CONFIG+=release && make && ./decoderbench
+QT       = core
+CONFIG  += c++17 console
+CONFIG  -= app_bundle
+TARGET   = decoderbench
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../binaryschema.cpp \
+    ../../builtindecoders.cpp
+
+HEADERS += \
+    ../../binaryschema.h \
+    ../../builtindecoders.h \
+    ../../fixedlayoutdecoder.h \
+    ../../packetdecoder.h
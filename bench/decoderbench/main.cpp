@@ -0,0 +1,115 @@
+// 同一段 imu6 帧流分别用 SchemaDecoder（协议描述解释执行）与 builtin imu6（FixedLayout 编译期布局）解码，
+// 先核对两者输出逐值一致，再各自重复解码多轮取最快一轮，输出每帧纳秒数。
+#include <QByteArray>
+#include <QString>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "binaryschema.h"
+#include "builtindecoders.h"
+
+namespace {
+constexpr int kFrames = 200000;
+constexpr int kRounds = 15;
+
+// 与 builtindecoders.cpp 中 Imu6 相同的布局
+const char kImu6Schema[] =
+    "sync AA 55\n"
+    "checksum sum8 2\n"
+    "packet * size 19\n"
+    "field acc 2 i16[3] scale 0.001\n"
+    "field gyro 8 i16[3] scale 0.01\n"
+    "field tick 14 u32\n";
+
+// 累加全部输出，防止解码被优化掉；需要时保存逐值结果用于核对
+class BenchSink : public FrameSink
+{
+public:
+    void frame(int firstChannel, const double *values, int count) override
+    {
+        for (int i = 0; i < count; ++i) sum += values[i];
+        if (keep) kept.insert(kept.end(), values, values + count);
+        frames += firstChannel >= 0 ? 1 : 0;
+    }
+    double sum = 0.0;
+    long long frames = 0;
+    bool keep = false;
+    std::vector<double> kept;
+};
+
+QByteArray makeStream()
+{
+    QByteArray stream;
+    stream.reserve(kFrames * 19);
+    unsigned seed = 12345;
+    for (int f = 0; f < kFrames; ++f) {
+        char frame[19];
+        frame[0] = static_cast<char>(0xAA);
+        frame[1] = static_cast<char>(0x55);
+        for (int i = 2; i < 14; ++i) {
+            seed = seed * 1103515245u + 12345u;
+            frame[i] = static_cast<char>(seed >> 16);
+        }
+        const quint32 tick = static_cast<quint32>(f);
+        std::memcpy(frame + 14, &tick, 4); // 小端主机
+        unsigned char sum = 0;
+        for (int i = 2; i < 18; ++i) sum = static_cast<unsigned char>(sum + static_cast<unsigned char>(frame[i]));
+        frame[18] = static_cast<char>(sum);
+        stream.append(frame, 19);
+    }
+    return stream;
+}
+
+double bestNsPerFrame(PacketDecoder &decoder, const QByteArray &stream)
+{
+    double best = 1e30;
+    for (int r = 0; r < kRounds; ++r) {
+        BenchSink sink;
+        const auto t0 = std::chrono::steady_clock::now();
+        decoder.decode(stream.constData(), static_cast<std::size_t>(stream.size()), sink);
+        const auto t1 = std::chrono::steady_clock::now();
+        if (sink.frames != kFrames) {
+            std::printf("decoded %lld of %d frames\n", sink.frames, kFrames);
+            return -1;
+        }
+        best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count() / kFrames);
+    }
+    return best;
+}
+} // namespace
+
+int main()
+{
+    BinarySchema schema;
+    QString error;
+    if (!BinarySchema::parse(QString::fromUtf8(kImu6Schema), schema, &error)) {
+        std::printf("schema error: %s\n", error.toUtf8().constData());
+        return 1;
+    }
+    SchemaDecoder interpreted(schema);
+    const std::shared_ptr<PacketDecoder> fixed = BuiltinDecoders::create(QStringLiteral("imu6"));
+    const QByteArray stream = makeStream();
+
+    // 两条路径必须给出相同的结果
+    BenchSink a;
+    BenchSink b;
+    a.keep = b.keep = true;
+    interpreted.decode(stream.constData(), static_cast<std::size_t>(stream.size()), a);
+    fixed->decode(stream.constData(), static_cast<std::size_t>(stream.size()), b);
+    if (a.kept != b.kept) {
+        std::printf("outputs differ\n");
+        return 1;
+    }
+
+    const double schemaNs = bestNsPerFrame(interpreted, stream);
+    const double fixedNs = bestNsPerFrame(*fixed, stream);
+    if (schemaNs < 0 || fixedNs < 0) return 1;
+    std::printf("imu6, %d frames x %d rounds (best round)\n", kFrames, kRounds);
+    std::printf("  SchemaDecoder          %7.2f ns/frame\n", schemaNs);
+    std::printf("  FixedLayout::Decoder   %7.2f ns/frame\n", fixedNs);
+    std::printf("  speedup                %7.2fx\n", schemaNs / fixedNs);
+    return 0;
+}
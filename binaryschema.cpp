@@ -0,0 +1,292 @@
+#include "binaryschema.h"
+
+#include <algorithm>
+
+namespace {
+using FieldType = BinarySchema::FieldType;
+
+bool parseType(QString token, FieldType &type, bool &bigEndian, int &count)
+{
+    token = token.toLower();
+    count = 1;
+    const int bracket = token.indexOf('[');
+    if (bracket >= 0) {
+        if (!token.endsWith(']')) return false;
+        bool ok = false;
+        count = token.mid(bracket + 1, token.size() - bracket - 2).toInt(&ok);
+        if (!ok || count < 1 || count > 256) return false;
+        token = token.left(bracket);
+    }
+    bigEndian = false;
+    if (token.endsWith(QStringLiteral("be"))) {
+        bigEndian = true;
+        token.chop(2);
+    } else if (token.endsWith(QStringLiteral("le"))) {
+        token.chop(2);
+    }
+    static const struct { const char *name; FieldType type; } kTypes[] = {
+        {"u8", FieldType::U8}, {"i8", FieldType::I8}, {"u16", FieldType::U16}, {"i16", FieldType::I16},
+        {"u32", FieldType::U32}, {"i32", FieldType::I32}, {"f32", FieldType::F32}, {"f64", FieldType::F64},
+    };
+    for (const auto &t : kTypes) {
+        if (token == QLatin1String(t.name)) {
+            type = t.type;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseInt(const QString &token, int &value)
+{
+    bool ok = false;
+    value = token.toInt(&ok, 0); // 支持 0x 前缀
+    return ok;
+}
+
+double readField(FieldType type, const char *p, bool bigEndian)
+{
+    switch (type) {
+    case FieldType::U8: return static_cast<quint8>(*p);
+    case FieldType::I8: return static_cast<qint8>(*p);
+    case FieldType::U16: return PacketCodec::load<quint16>(p, bigEndian);
+    case FieldType::I16: return PacketCodec::load<qint16>(p, bigEndian);
+    case FieldType::U32: return PacketCodec::load<quint32>(p, bigEndian);
+    case FieldType::I32: return PacketCodec::load<qint32>(p, bigEndian);
+    case FieldType::F32: return PacketCodec::load<float>(p, bigEndian);
+    case FieldType::F64: return PacketCodec::load<double>(p, bigEndian);
+    }
+    return 0.0;
+}
+} // namespace
+
+int BinarySchema::typeSize(FieldType type)
+{
+    switch (type) {
+    case FieldType::U8:
+    case FieldType::I8: return 1;
+    case FieldType::U16:
+    case FieldType::I16: return 2;
+    case FieldType::U32:
+    case FieldType::I32:
+    case FieldType::F32: return 4;
+    case FieldType::F64: return 8;
+    }
+    return 1;
+}
+
+bool BinarySchema::parse(const QString &text, BinarySchema &schema, QString *error)
+{
+    schema = BinarySchema();
+    auto fail = [error](int lineNo, const QString &message) {
+        if (error) *error = QString::fromUtf8(u8"第 %1 行：%2").arg(lineNo).arg(message);
+        return false;
+    };
+
+    const QStringList lines = text.split('\n');
+    for (int i = 0; i < lines.size(); ++i) {
+        const int lineNo = i + 1;
+        QString line = lines.at(i);
+        const int hash = line.indexOf('#');
+        if (hash >= 0) line.truncate(hash);
+        const QStringList tok = line.simplified().split(' ', Qt::SkipEmptyParts);
+        if (tok.isEmpty()) continue;
+        const QString key = tok.at(0).toLower();
+
+        if (key == QLatin1String("sync")) {
+            for (int t = 1; t < tok.size(); ++t) {
+                QString hex = tok.at(t);
+                if (hex.startsWith(QLatin1String("0x"), Qt::CaseInsensitive)) hex = hex.mid(2);
+                if (hex.isEmpty() || hex.size() % 2 != 0) return fail(lineNo, QString::fromUtf8(u8"帧头字节格式错误"));
+                for (int k = 0; k < hex.size(); k += 2) {
+                    bool ok = false;
+                    const int b = hex.mid(k, 2).toInt(&ok, 16);
+                    if (!ok) return fail(lineNo, QString::fromUtf8(u8"帧头字节格式错误"));
+                    schema.sync.append(static_cast<char>(b));
+                }
+            }
+        } else if (key == QLatin1String("id") || key == QLatin1String("len")) {
+            int offset = 0;
+            int count = 1;
+            FieldType type = FieldType::U8;
+            bool big = false;
+            if (tok.size() < 3 || !parseInt(tok.at(1), offset) || offset < 0
+                || !parseType(tok.at(2), type, big, count) || count != 1
+                || type == FieldType::F32 || type == FieldType::F64) {
+                return fail(lineNo, QString::fromUtf8(u8"应为：%1 偏移 整数类型").arg(key));
+            }
+            if (key == QLatin1String("id")) {
+                schema.idOffset = offset;
+                schema.idType = type;
+                schema.idBigEndian = big;
+            } else {
+                schema.lenOffset = offset;
+                schema.lenType = type;
+                schema.lenBigEndian = big;
+                if (tok.size() >= 4 && !parseInt(tok.at(3), schema.lenAdd)) {
+                    return fail(lineNo, QString::fromUtf8(u8"长度附加字节数错误"));
+                }
+            }
+        } else if (key == QLatin1String("checksum")) {
+            const QString kind = tok.value(1).toLower();
+            if (kind == QLatin1String("sum8")) schema.checksum = PacketCodec::Checksum::Sum8;
+            else if (kind == QLatin1String("xor8")) schema.checksum = PacketCodec::Checksum::Xor8;
+            else if (kind == QLatin1String("crc16")) schema.checksum = PacketCodec::Checksum::Crc16Modbus;
+            else if (kind == QLatin1String("none")) schema.checksum = PacketCodec::Checksum::None;
+            else return fail(lineNo, QString::fromUtf8(u8"校验类型应为 sum8/xor8/crc16/none"));
+            if (tok.size() >= 3 && (!parseInt(tok.at(2), schema.checksumStart) || schema.checksumStart < 0)) {
+                return fail(lineNo, QString::fromUtf8(u8"校验起始偏移错误"));
+            }
+        } else if (key == QLatin1String("packet")) {
+            Packet packet;
+            if (tok.size() < 2) return fail(lineNo, QString::fromUtf8(u8"缺少包类型"));
+            if (tok.at(1) != QLatin1String("*") && !parseInt(tok.at(1), packet.id)) {
+                return fail(lineNo, QString::fromUtf8(u8"包类型应为数字或 *"));
+            }
+            for (int t = 2; t + 1 < tok.size(); t += 2) {
+                if (tok.at(t).toLower() != QLatin1String("size") || !parseInt(tok.at(t + 1), packet.size)
+                    || packet.size <= 0 || packet.size > SchemaDecoder::kMaxFrameSize) {
+                    return fail(lineNo, QString::fromUtf8(u8"应为：packet 类型 size 帧长"));
+                }
+            }
+            schema.packets.append(packet);
+        } else if (key == QLatin1String("field")) {
+            Field field;
+            if (tok.size() < 4 || !parseInt(tok.at(2), field.offset) || field.offset < 0
+                || !parseType(tok.at(3), field.type, field.bigEndian, field.count)) {
+                return fail(lineNo, QString::fromUtf8(u8"应为：field 名称 偏移 类型 [scale 系数] [offset 偏置]"));
+            }
+            field.name = tok.at(1);
+            for (int t = 4; t + 1 < tok.size(); t += 2) {
+                const QString opt = tok.at(t).toLower();
+                bool ok = false;
+                const double v = tok.at(t + 1).toDouble(&ok);
+                if (!ok) return fail(lineNo, QString::fromUtf8(u8"数值错误：%1").arg(tok.at(t + 1)));
+                if (opt == QLatin1String("scale")) field.scale = v;
+                else if (opt == QLatin1String("offset")) field.offsetValue = v;
+                else return fail(lineNo, QString::fromUtf8(u8"未知选项：%1").arg(tok.at(t)));
+            }
+            if (schema.packets.isEmpty()) schema.packets.append(Packet()); // 未写 packet 时为单一包类型
+            schema.packets.last().fields.append(field);
+        } else {
+            return fail(lineNo, QString::fromUtf8(u8"未知关键字：%1").arg(tok.at(0)));
+        }
+    }
+
+    if (schema.packets.isEmpty()) return fail(lines.size(), QString::fromUtf8(u8"没有定义任何字段"));
+    if (schema.packets.size() > 1 && schema.idOffset < 0) {
+        return fail(lines.size(), QString::fromUtf8(u8"多种包类型时需要 id 字段"));
+    }
+
+    // 分配通道序号，计算每种包的最小帧长
+    const int csSize = PacketCodec::checksumSize(schema.checksum);
+    for (Packet &packet : schema.packets) {
+        packet.firstChannel = schema.channelNames.size();
+        int minSize = schema.checksumStart + csSize;
+        for (Field &field : packet.fields) {
+            field.firstChannel = schema.channelNames.size();
+            if (field.count == 1) {
+                schema.channelNames << field.name;
+            } else {
+                for (int k = 0; k < field.count; ++k) {
+                    schema.channelNames << QStringLiteral("%1[%2]").arg(field.name).arg(k);
+                }
+            }
+            minSize = std::max(minSize, field.offset + field.count * typeSize(field.type) + csSize);
+        }
+        packet.channelCount = schema.channelNames.size() - packet.firstChannel;
+        packet.minSize = minSize;
+        if (packet.size == 0 && schema.lenOffset < 0) {
+            return fail(lines.size(), QString::fromUtf8(u8"包 %1 没有 size，也没有 len 字段").arg(packet.id));
+        }
+        if (packet.size > 0 && packet.size < packet.minSize) {
+            return fail(lines.size(), QString::fromUtf8(u8"包 %1 的字段超出帧长").arg(packet.id));
+        }
+    }
+    return true;
+}
+
+SchemaDecoder::SchemaDecoder(const BinarySchema &schema)
+    : m_schema(schema)
+{
+    m_headerSize = std::max(1, static_cast<int>(m_schema.sync.size()));
+    if (m_schema.idOffset >= 0) {
+        m_headerSize = std::max(m_headerSize, m_schema.idOffset + BinarySchema::typeSize(m_schema.idType));
+    }
+    if (m_schema.lenOffset >= 0) {
+        m_headerSize = std::max(m_headerSize, m_schema.lenOffset + BinarySchema::typeSize(m_schema.lenType));
+    }
+    int maxChannels = 0;
+    for (const BinarySchema::Packet &packet : m_schema.packets) {
+        maxChannels = std::max(maxChannels, packet.channelCount);
+    }
+    m_values.resize(static_cast<std::size_t>(maxChannels));
+}
+
+const BinarySchema::Packet *SchemaDecoder::findPacket(int id) const
+{
+    for (const BinarySchema::Packet &packet : m_schema.packets) {
+        if (packet.id < 0 || packet.id == id) return &packet;
+    }
+    return nullptr;
+}
+
+std::size_t SchemaDecoder::decode(const char *data, std::size_t size, FrameSink &sink)
+{
+    const std::size_t syncLen = static_cast<std::size_t>(m_schema.sync.size());
+    const int csSize = PacketCodec::checksumSize(m_schema.checksum);
+    std::size_t pos = 0;
+    while (pos < size) {
+        const std::size_t found = PacketCodec::findSync(data + pos, size - pos, m_schema.sync.constData(), syncLen);
+        if (found == size - pos) {
+            // 没有帧头：保留末尾可能是半个帧头的字节
+            const std::size_t keep = std::min(syncLen > 0 ? syncLen - 1 : 0, size - pos);
+            m_stats.skippedBytes += size - pos - keep;
+            pos = size - keep;
+            break;
+        }
+        m_stats.skippedBytes += found;
+        pos += found;
+
+        const char *frame = data + pos;
+        const std::size_t avail = size - pos;
+        if (avail < static_cast<std::size_t>(m_headerSize)) break;
+
+        const int id = (m_schema.idOffset >= 0)
+                           ? static_cast<int>(readField(m_schema.idType, frame + m_schema.idOffset, m_schema.idBigEndian))
+                           : -1;
+        const BinarySchema::Packet *packet = findPacket(id);
+        int frameLen = packet ? packet->size : 0;
+        if (packet && m_schema.lenOffset >= 0) {
+            frameLen = static_cast<int>(readField(m_schema.lenType, frame + m_schema.lenOffset, m_schema.lenBigEndian))
+                       + m_schema.lenAdd;
+        }
+        if (!packet || frameLen < packet->minSize || frameLen < m_headerSize || frameLen > kMaxFrameSize) {
+            ++m_stats.skippedBytes; // 误判的帧头，向后一个字节重新同步
+            ++pos;
+            continue;
+        }
+        if (avail < static_cast<std::size_t>(frameLen)) break;
+
+        const auto *bytes = reinterpret_cast<const unsigned char *>(frame);
+        if (!PacketCodec::verifyChecksum(m_schema.checksum, bytes + m_schema.checksumStart,
+                                         bytes + frameLen - csSize)) {
+            ++m_stats.checksumErrors;
+            ++pos;
+            continue;
+        }
+
+        double *out = m_values.data();
+        for (const BinarySchema::Field &field : packet->fields) {
+            const int step = BinarySchema::typeSize(field.type);
+            const char *p = frame + field.offset;
+            for (int k = 0; k < field.count; ++k, p += step) {
+                *out++ = readField(field.type, p, field.bigEndian) * field.scale + field.offsetValue;
+            }
+        }
+        sink.frame(packet->firstChannel, m_values.data(), packet->channelCount);
+        ++m_stats.frames;
+        pos += static_cast<std::size_t>(frameLen);
+    }
+    return pos;
+}
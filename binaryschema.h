@@ -0,0 +1,81 @@
+#ifndef BINARYSCHEMA_H
+#define BINARYSCHEMA_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <vector>
+#include "packetdecoder.h"
+
+// 声明式二进制协议描述，格式设置里按行书写，例如：
+//   sync AA 55                 帧头字节（十六进制）
+//   id 2 u8                    包类型字段：偏移 类型（可省略，省略时只能有一种包）
+//   len 3 u8 +6                长度字段：偏移 类型 附加字节数，帧长 = 字段值 + 附加
+//   checksum sum8 2            校验：sum8/xor8/crc16，从偏移 2 到校验值之前，校验值在帧尾
+//   packet 0x01 size 16        包类型（* 表示任意）与帧长（有 len 时可省略）
+//   field temp 4 i16 scale 0.01 offset -40
+//   field acc 6 i16be[3] scale 0.001
+// 类型：u8 i8 u16 i16 u32 i32 f32 f64，后缀 le/be 指定字节序（默认小端），[N] 为数组
+struct BinarySchema {
+    enum class FieldType { U8, I8, U16, I16, U32, I32, F32, F64 };
+
+    struct Field {
+        QString name;
+        int offset = 0;
+        FieldType type = FieldType::U8;
+        bool bigEndian = false;
+        double scale = 1.0;
+        double offsetValue = 0.0;
+        int count = 1;
+        int firstChannel = 0;
+    };
+
+    struct Packet {
+        int id = -1; // -1 表示任意包类型
+        int size = 0; // 0 表示由长度字段决定
+        int minSize = 0; // 字段与校验值所需的最小帧长
+        QVector<Field> fields;
+        int firstChannel = 0;
+        int channelCount = 0;
+    };
+
+    QByteArray sync;
+    int idOffset = -1;
+    FieldType idType = FieldType::U8;
+    bool idBigEndian = false;
+    int lenOffset = -1;
+    FieldType lenType = FieldType::U8;
+    bool lenBigEndian = false;
+    int lenAdd = 0;
+    PacketCodec::Checksum checksum = PacketCodec::Checksum::None;
+    int checksumStart = 0;
+    QVector<Packet> packets;
+    QStringList channelNames;
+
+    static int typeSize(FieldType type);
+
+    // 解析失败时返回 false，error 给出出错行
+    static bool parse(const QString &text, BinarySchema &schema, QString *error);
+};
+
+// 按协议描述解释执行的解码器
+class SchemaDecoder : public PacketDecoder
+{
+public:
+    explicit SchemaDecoder(const BinarySchema &schema);
+
+    QStringList channelNames() const override { return m_schema.channelNames; }
+    std::size_t decode(const char *data, std::size_t size, FrameSink &sink) override;
+
+    static constexpr int kMaxFrameSize = 4096;
+
+private:
+    const BinarySchema::Packet *findPacket(int id) const;
+
+    BinarySchema m_schema;
+    int m_headerSize = 0; // 读取帧头、包类型、长度字段所需的字节数
+    std::vector<double> m_values;
+};
+
+#endif // BINARYSCHEMA_H
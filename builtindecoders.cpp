@@ -0,0 +1,44 @@
+#include "builtindecoders.h"
+
+#include "fixedlayoutdecoder.h"
+
+namespace BuiltinDecoders {
+
+namespace {
+using FixedLayout::Array;
+using FixedLayout::Endian;
+using FixedLayout::Field;
+using FixedLayout::Sync;
+using PacketCodec::Checksum;
+
+// 六轴 IMU：AA 55 | 加速度 3×i16 (mg) | 角速度 3×i16 (0.01°/s) | u32 计数 | sum8
+using Imu6 = FixedLayout::Decoder<Sync<0xAA, 0x55>, 19, Checksum::Sum8, 2,
+                                  Array<std::int16_t, 2, 3, Endian::Little, std::ratio<1, 1000>>,
+                                  Array<std::int16_t, 8, 3, Endian::Little, std::ratio<1, 100>>,
+                                  Field<std::uint32_t, 14>>;
+
+// 姿态：AA 55 | roll pitch yaw 3×f32 (°) | xor8
+using Attitude = FixedLayout::Decoder<Sync<0xAA, 0x55>, 15, Checksum::Xor8, 2,
+                                      Array<float, 2, 3>>;
+} // namespace
+
+QStringList names()
+{
+    return {QStringLiteral("imu6"), QStringLiteral("attitude")};
+}
+
+std::shared_ptr<PacketDecoder> create(const QString &name)
+{
+    if (name == QLatin1String("imu6")) {
+        return std::make_shared<Imu6>(QStringList{QStringLiteral("ax"), QStringLiteral("ay"), QStringLiteral("az"),
+                                                  QStringLiteral("gx"), QStringLiteral("gy"), QStringLiteral("gz"),
+                                                  QStringLiteral("tick")});
+    }
+    if (name == QLatin1String("attitude")) {
+        return std::make_shared<Attitude>(QStringList{QStringLiteral("roll"), QStringLiteral("pitch"),
+                                                      QStringLiteral("yaw")});
+    }
+    return nullptr;
+}
+
+} // namespace BuiltinDecoders
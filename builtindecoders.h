@@ -0,0 +1,18 @@
+#ifndef BUILTINDECODERS_H
+#define BUILTINDECODERS_H
+
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include "packetdecoder.h"
+
+// 内置的编译期定长解码器（见 fixedlayoutdecoder.h），用于高帧率设备。
+// 协议描述写成 "builtin 名称" 即可选用，与 SchemaDecoder 走同一个分帧/通道接口。
+namespace BuiltinDecoders {
+
+QStringList names();
+std::shared_ptr<PacketDecoder> create(const QString &name); // 未知名称返回 nullptr
+
+} // namespace BuiltinDecoders
+
+#endif // BUILTINDECODERS_H
@@ -0,0 +1,221 @@
+#include "channelregistry.h"
+
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+ChannelStore::ChannelStore(const QString &name, ChannelType type, int capacity)
+    : m_name(name)
+    , m_type(type)
+    , m_capacity(qMax(1, capacity))
+{
+}
+
+void ChannelStore::append(qint64 timestampMs, double value)
+{
+    QMutexLocker locker(&m_mutex);
+    // 未满时按需增长，满后覆盖最旧的样本
+    if (m_total < static_cast<quint64>(m_capacity)) {
+        m_time.push_back(timestampMs);
+        m_value.push_back(value);
+    } else {
+        const std::size_t slot = static_cast<std::size_t>(m_total % static_cast<quint64>(m_capacity));
+        m_time[slot] = timestampMs;
+        m_value[slot] = value;
+    }
+    ++m_total;
+    publish(timestampMs, value, value, value);
+}
+
+void ChannelStore::append(const qint64 *timestampsMs, const double *values, int count)
+{
+    if (count <= 0) return;
+    QMutexLocker locker(&m_mutex);
+    const quint64 cap = static_cast<quint64>(m_capacity);
+    double blockMin = values[0];
+    double blockMax = values[0];
+    for (int i = 0; i < count; ++i) {
+        blockMin = values[i] < blockMin ? values[i] : blockMin;
+        blockMax = values[i] > blockMax ? values[i] : blockMax;
+        if (m_total < cap) {
+            m_time.push_back(timestampsMs[i]);
+            m_value.push_back(values[i]);
+        } else {
+            const std::size_t slot = static_cast<std::size_t>(m_total % cap);
+            m_time[slot] = timestampsMs[i];
+            m_value[slot] = values[i];
+        }
+        ++m_total;
+    }
+    publish(timestampsMs[count - 1], values[count - 1], blockMin, blockMax);
+}
+
+void ChannelStore::publish(qint64 timestampMs, double value, double blockMin, double blockMax)
+{
+    const quint32 seq = m_seq.load(std::memory_order_relaxed);
+    m_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    if (!m_rangeValid) {
+        m_min.store(blockMin, std::memory_order_relaxed);
+        m_max.store(blockMax, std::memory_order_relaxed);
+        m_rangeValid = true;
+    } else {
+        if (blockMin < m_min.load(std::memory_order_relaxed)) m_min.store(blockMin, std::memory_order_relaxed);
+        if (blockMax > m_max.load(std::memory_order_relaxed)) m_max.store(blockMax, std::memory_order_relaxed);
+    }
+    m_lastTime.store(timestampMs, std::memory_order_relaxed);
+    m_lastValue.store(value, std::memory_order_relaxed);
+    m_count.store(m_total, std::memory_order_relaxed);
+    m_seq.store(seq + 2, std::memory_order_release);
+}
+
+bool ChannelStore::snapshot(ChannelSnapshot &out) const
+{
+    for (;;) {
+        const quint32 before = m_seq.load(std::memory_order_acquire);
+        if (before & 1u) continue;
+        out.timestampMs = m_lastTime.load(std::memory_order_relaxed);
+        out.value = m_lastValue.load(std::memory_order_relaxed);
+        out.min = m_min.load(std::memory_order_relaxed);
+        out.max = m_max.load(std::memory_order_relaxed);
+        out.count = m_count.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_seq.load(std::memory_order_relaxed) == before) break;
+    }
+    return out.count > 0;
+}
+
+void ChannelStore::resetRange()
+{
+    QMutexLocker locker(&m_mutex);
+    m_rangeValid = false;
+}
+
+void ChannelStore::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_time.clear();
+    m_value.clear();
+    m_total = 0;
+    m_rangeValid = false;
+    const quint32 seq = m_seq.load(std::memory_order_relaxed);
+    m_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_count.store(0, std::memory_order_relaxed);
+    m_seq.store(seq + 2, std::memory_order_release);
+}
+
+quint64 ChannelStore::totalCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_total;
+}
+
+bool ChannelStore::latest(qint64 &timestampMs, double &value) const
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_total == 0) return false;
+    const std::size_t slot = static_cast<std::size_t>((m_total - 1) % static_cast<quint64>(m_capacity));
+    timestampMs = m_time[slot];
+    value = m_value[slot];
+    return true;
+}
+
+quint64 ChannelStore::readSince(quint64 fromSeq, QVector<qint64> &timestamps, QVector<double> &values) const
+{
+    QMutexLocker locker(&m_mutex);
+    const quint64 cap = static_cast<quint64>(m_capacity);
+    const quint64 oldest = (m_total > cap) ? m_total - cap : 0;
+    quint64 seq = qMax(fromSeq, oldest);
+    if (seq > m_total) seq = oldest; // 通道被清空过，从头读
+    timestamps.reserve(timestamps.size() + static_cast<qsizetype>(m_total - seq));
+    values.reserve(values.size() + static_cast<qsizetype>(m_total - seq));
+    for (; seq < m_total; ++seq) {
+        const std::size_t slot = static_cast<std::size_t>(seq % cap);
+        timestamps.append(m_time[slot]);
+        values.append(m_value[slot]);
+    }
+    return m_total;
+}
+
+ChannelRegistry::ChannelRegistry(QObject *parent)
+    : QObject(parent)
+{
+}
+
+int ChannelRegistry::ensureChannel(const QString &name, ChannelType type)
+{
+    {
+        QReadLocker locker(&m_lock);
+        const auto it = m_index.constFind(name);
+        if (it != m_index.constEnd()) return it.value();
+    }
+    int id = -1;
+    {
+        QWriteLocker locker(&m_lock);
+        const auto it = m_index.constFind(name);
+        if (it != m_index.constEnd()) return it.value();
+        id = static_cast<int>(m_channels.size());
+        m_channels.push_back(std::make_unique<ChannelStore>(name, type, kDefaultCapacity));
+        m_index.insert(name, id);
+    }
+    emit channelAdded(id, name);
+    return id;
+}
+
+int ChannelRegistry::channelId(const QString &name) const
+{
+    QReadLocker locker(&m_lock);
+    return m_index.value(name, -1);
+}
+
+int ChannelRegistry::channelCount() const
+{
+    QReadLocker locker(&m_lock);
+    return static_cast<int>(m_channels.size());
+}
+
+QStringList ChannelRegistry::channelNames() const
+{
+    QReadLocker locker(&m_lock);
+    QStringList names;
+    names.reserve(static_cast<qsizetype>(m_channels.size()));
+    for (const auto &ch : m_channels) names << ch->name();
+    return names;
+}
+
+ChannelStore *ChannelRegistry::channel(int id) const
+{
+    QReadLocker locker(&m_lock);
+    if (id < 0 || id >= static_cast<int>(m_channels.size())) return nullptr;
+    return m_channels[static_cast<std::size_t>(id)].get();
+}
+
+void ChannelRegistry::append(int id, qint64 timestampMs, double value)
+{
+    ChannelStore *ch = channel(id);
+    if (ch) ch->append(timestampMs, value);
+}
+
+void ChannelRegistry::notifyAppended()
+{
+    if (m_derivedStage.load()) {
+        emit sourcesAppended();
+    } else {
+        emit samplesAppended();
+    }
+}
+
+void ChannelRegistry::publishAppended()
+{
+    emit samplesAppended();
+}
+
+void ChannelRegistry::clear()
+{
+    {
+        QReadLocker locker(&m_lock);
+        for (const auto &ch : m_channels) ch->clear();
+    }
+    emit channelsCleared();
+}
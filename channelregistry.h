@@ -0,0 +1,121 @@
+#ifndef CHANNELREGISTRY_H
+#define CHANNELREGISTRY_H
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// 通道数据类型：数值一律以 double 保存，类型用于显示和导出时还原
+enum class ChannelType {
+    Real,
+    Integer,
+};
+
+// 通道最新值与统计，供监视表等低频读取
+struct ChannelSnapshot {
+    qint64 timestampMs = 0;
+    double value = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    quint64 count = 0;
+};
+
+// 单个通道的带时间戳存储：固定容量的环形缓冲（时间、数值分开存放），
+// 写入端为提取线程，读取端按序号增量拉取，互不复制整个缓冲。
+class ChannelStore
+{
+public:
+    ChannelStore(const QString &name, ChannelType type, int capacity);
+
+    QString name() const { return m_name; }
+    ChannelType type() const { return m_type; }
+
+    void append(qint64 timestampMs, double value);
+    void append(const qint64 *timestampsMs, const double *values, int count); // 整块写入，只加一次锁
+    void clear();
+
+    // 已写入的样本总数（单调递增，可作为增量读取的序号）
+    quint64 totalCount() const;
+    bool latest(qint64 &timestampMs, double &value) const;
+
+    // 无锁读取最新值与最值（顺序锁，写入端已由 m_mutex 串行化），无数据时返回 false
+    bool snapshot(ChannelSnapshot &out) const;
+    void resetRange(); // 最值从下一个样本重新统计
+
+    // 读取序号 fromSeq 之后仍保留在缓冲中的样本，返回下一次读取应使用的序号
+    quint64 readSince(quint64 fromSeq, QVector<qint64> &timestamps, QVector<double> &values) const;
+
+private:
+    void publish(qint64 timestampMs, double value, double blockMin, double blockMax); // 需持有 m_mutex
+
+    const QString m_name;
+    const ChannelType m_type;
+    const int m_capacity;
+
+    mutable QMutex m_mutex;
+    std::vector<qint64> m_time;
+    std::vector<double> m_value;
+    quint64 m_total = 0;
+
+    // 顺序锁保护的最新值：奇数表示正在写
+    std::atomic<quint32> m_seq{0};
+    std::atomic<qint64> m_lastTime{0};
+    std::atomic<double> m_lastValue{0.0};
+    std::atomic<double> m_min{0.0};
+    std::atomic<double> m_max{0.0};
+    std::atomic<quint64> m_count{0};
+    bool m_rangeValid = false;
+};
+
+// 通道注册表：按名称登记通道，提取/解码阶段写入，波形、表格等视图按通道订阅。
+// 所有接口线程安全；新增通道与新数据通过信号通知（跨线程时为排队连接）。
+class ChannelRegistry : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ChannelRegistry(QObject *parent = nullptr);
+
+    static constexpr int kDefaultCapacity = 200000;
+
+    // 不存在时创建，返回通道序号
+    int ensureChannel(const QString &name, ChannelType type = ChannelType::Real);
+    int channelId(const QString &name) const; // 不存在时返回 -1
+    int channelCount() const;
+    QStringList channelNames() const;
+
+    // 序号在注册表生命周期内有效，返回的指针可跨线程使用
+    ChannelStore *channel(int id) const;
+
+    void append(int id, qint64 timestampMs, double value);
+
+    // 写入端一个批次结束后调用，通知订阅者拉取新数据。
+    // 设置了派生通道计算阶段时先发 sourcesAppended 交给它，算完后由它调用 publishAppended，
+    // 每批数据只通知订阅者一次，派生通道的输出也在同一次通知里
+    void notifyAppended();
+    void publishAppended();
+    void setDerivedStage(bool enabled) { m_derivedStage.store(enabled); }
+
+    // 清空全部通道的数据（通道本身保留，已取得的指针仍然有效）
+    void clear();
+
+signals:
+    void channelAdded(int id, QString name);
+    void channelsCleared();
+    void samplesAppended();
+    void sourcesAppended(); // 只发给派生通道计算阶段
+
+private:
+    mutable QReadWriteLock m_lock;
+    std::vector<std::unique_ptr<ChannelStore>> m_channels;
+    QHash<QString, int> m_index;
+    std::atomic<bool> m_derivedStage{false};
+};
+
+#endif // CHANNELREGISTRY_H
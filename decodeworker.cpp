@@ -0,0 +1,226 @@
+#include "decodeworker.h"
+
+#include <QDateTime>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HICOM_HAVE_SSE2 1
+#endif
+
+namespace {
+// 在字节流中查找下一个 '\r' 或 '\n'，返回指针；找不到返回 end。
+// '\r'/'\n' 在 UTF-8 和 GB18030 中都不会出现在多字节字符内部，可以先按字节切行再解码。
+const char* findLineEnd(const char* p, const char* end)
+{
+#ifdef HICOM_HAVE_SSE2
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+        if (mask != 0) {
+#if defined(__GNUC__) || defined(__clang__)
+            return p + __builtin_ctz(static_cast<unsigned>(mask));
+#else
+            for (int i = 0; i < 16; ++i) {
+                if (mask & (1 << i)) return p + i;
+            }
+#endif
+        }
+        p += 16;
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == '\r' || *p == '\n') return p;
+    }
+    return end;
+}
+} // namespace
+
+DecodeWorker::DecodeWorker(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void DecodeWorker::reset(const QString &encodingName)
+{
+    m_autoDetect = (encodingName.compare(QStringLiteral("自动识别")) == 0
+                    || encodingName.compare(QStringLiteral("Auto"), Qt::CaseInsensitive) == 0);
+    m_classifier.reset();
+    m_decoderKind = StreamClassifier::TextUtf8;
+    if (m_autoDetect) {
+        m_decoder = QStringDecoder(QStringConverter::Utf8);
+    } else if (encodingName.compare(QStringLiteral("UTF-8"), Qt::CaseInsensitive) == 0) {
+        m_decoder = QStringDecoder(QStringConverter::Utf8);
+    } else if (encodingName.compare(QStringLiteral("GBK"), Qt::CaseInsensitive) == 0
+               || encodingName.compare(QStringLiteral("GB18030"), Qt::CaseInsensitive) == 0) {
+        m_decoder = QStringDecoder("GB18030");
+    } else if (encodingName.compare(QStringLiteral("本地编码")) == 0
+               || encodingName.compare(QStringLiteral("Local")) == 0) {
+        m_decoder = QStringDecoder(QStringConverter::System);
+    } else {
+        m_decoder = QStringDecoder(QStringConverter::Utf8);
+    }
+    m_carry.clear();
+    m_pendingCr = false;
+    m_lastFlushMs = 0;
+    m_collapser.reset();
+}
+
+void DecodeWorker::setHexMode(bool on)
+{
+    m_hexMode = on;
+}
+
+void DecodeWorker::setLineMode(bool on)
+{
+    if (m_lineMode == on) return;
+    m_lineMode = on;
+    m_carry.clear();
+    m_pendingCr = false;
+    m_collapser.reset();
+}
+
+void DecodeWorker::setCollapse(bool enabled, bool ignoreDigits)
+{
+    m_collapser.setEnabled(enabled);
+    m_collapser.setIgnoreDigits(ignoreDigits);
+}
+
+void DecodeWorker::setHighlightRules(const QStringList &specs)
+{
+    m_highlight.compile(specs);
+}
+
+void DecodeWorker::processPacket(const QByteArray &packet)
+{
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    DecodedBatch batch;
+    batch.byteCount = packet.size();
+    batch.timestampMs = nowMs;
+
+    if (m_hexMode) {
+        batch.text = m_decoder.decode(packet);
+        m_collapser.reset();
+        appendHex(packet, nowMs, batch);
+    } else if (m_autoDetect && routeAutoDetect(packet, nowMs, batch)) {
+        // 二进制块已按 HEX 输出
+    } else if (!m_lineMode) {
+        // 未勾选自动换行：每包直接输出，不额外换行
+        batch.text = m_decoder.decode(packet);
+        m_collapser.reset();
+        RecvLine rl{nowMs, batch.text, false};
+        rl.styles = m_highlight.evaluate(rl.text);
+        batch.lines.append(rl);
+        m_lastFlushMs = nowMs;
+    } else {
+        splitLines(packet, nowMs, batch);
+    }
+    emit batchReady(batch);
+}
+
+void DecodeWorker::appendHex(const QByteArray &packet, qint64 nowMs, DecodedBatch &batch)
+{
+    batch.lines.append(RecvLine{nowMs, QString::fromLatin1(packet.toHex(' ').toUpper()), m_lineMode});
+    m_lastFlushMs = nowMs;
+}
+
+bool DecodeWorker::routeAutoDetect(const QByteArray &packet, qint64 nowMs, DecodedBatch &batch)
+{
+    const StreamClassifier::Kind kind = m_classifier.feed(packet.constData(), static_cast<size_t>(packet.size()));
+    if (kind == StreamClassifier::Binary) {
+        // 二进制块不解码、不参与提取，直接按 HEX 渲染；之前的半行先单独输出
+        if (!m_carry.isEmpty()) {
+            emitLine(m_carry, nowMs, batch);
+            m_carry.clear();
+        }
+        m_collapser.reset();
+        m_pendingCr = false;
+        m_decoder.resetState();
+        batch.lines.append(RecvLine{nowMs, QString::fromLatin1(packet.toHex(' ').toUpper()), true});
+        m_lastFlushMs = nowMs;
+        return true;
+    }
+    if (kind != m_decoderKind) {
+        m_decoderKind = kind;
+        m_decoder = (kind == StreamClassifier::TextGb18030) ? QStringDecoder("GB18030")
+                                                            : QStringDecoder(QStringConverter::Utf8);
+    }
+    return false;
+}
+
+void DecodeWorker::emitLine(const QString &text, qint64 nowMs, DecodedBatch &batch)
+{
+    if (!m_collapser.feed(text, nowMs)) {
+        RecvLine rl{nowMs, text, true};
+        rl.styles = m_highlight.evaluate(text);
+        batch.lines.append(rl);
+        return;
+    }
+    // 重复行：不同内容会打断重复段，所以批次中已有的最后一条必属于当前段，
+    // 就地刷新计数与最新内容，同一批次内只保留一条记录
+    const int n = m_collapser.count();
+    if (!batch.lines.isEmpty()) {
+        RecvLine &last = batch.lines.last();
+        last.text = text;
+        last.repeat = n;
+        last.lastMs = nowMs;
+        last.styles = m_highlight.evaluate(text);
+        return;
+    }
+    RecvLine rl{m_collapser.firstMs(), text, true};
+    rl.styles = m_highlight.evaluate(text);
+    rl.repeat = n;
+    rl.lastMs = nowMs;
+    rl.updatesPrevious = true;
+    batch.lines.append(rl);
+}
+
+void DecodeWorker::splitLines(const QByteArray &packet, qint64 nowMs, DecodedBatch &batch)
+{
+    // 勾选自动换行：仅按换行符换行，超时才按当前缓冲输出
+    const char* p = packet.constData();
+    const char* const end = p + packet.size();
+    if (m_pendingCr && p < end && *p == '\n') {
+        ++p;
+    }
+    m_pendingCr = false;
+
+    bool hasEol = false;
+    while (p < end) {
+        const char* eol = findLineEnd(p, end);
+        const QString piece = m_decoder.decode(QByteArrayView(p, eol - p));
+        batch.text += piece;
+        if (eol == end) {
+            m_carry += piece;
+            break;
+        }
+
+        hasEol = true;
+        batch.text += QLatin1Char('\n');
+        m_carry += piece;
+        emitLine(m_carry, nowMs, batch);
+        m_carry.clear();
+
+        p = eol + 1;
+        if (*eol == '\r') {
+            if (p == end) {
+                m_pendingCr = true;
+            } else if (*p == '\n') {
+                ++p;
+            }
+        }
+    }
+
+    // 无换行时不立即输出，等待后续；但若超时则按当前缓冲输出一行
+    const qint64 gap = (m_lastFlushMs > 0) ? (nowMs - m_lastFlushMs) : std::numeric_limits<qint64>::max();
+    if (!hasEol && !m_carry.isEmpty() && gap > kPartialFlushMs) {
+        emitLine(m_carry, nowMs, batch);
+        m_carry.clear();
+    }
+    if (!batch.lines.isEmpty()) {
+        m_lastFlushMs = nowMs;
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef DECODEWORKER_H
+#define DECODEWORKER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QMetaType>
+#include <QString>
+#include <QStringDecoder>
+#include <QVector>
+#include "highlightrules.h"
+#include "linecollapser.h"
+#include "textclassifier.h"
+
+// 一条待显示的接收记录：完整行、超时输出的半行、未分行模式下的整包或 HEX 文本
+struct RecvLine {
+    qint64 timestampMs = 0;
+    QString text;
+    bool lineEnd = false;
+    int repeat = 1;               // 折叠后的重复次数
+    qint64 lastMs = 0;            // 重复段最后一次出现的时间
+    bool updatesPrevious = false; // 只更新上一条已显示行的计数，不新增行
+    QVector<StyleRun> styles;     // 着色规则命中区间，绘制时叠加
+};
+
+// 每个串口数据包解码后的结果，GUI 只负责渲染
+struct DecodedBatch {
+    qint64 byteCount = 0;
+    qint64 timestampMs = 0;
+    QString text;              // 整包解码文本，供提取/匹配使用
+    QVector<RecvLine> lines;
+};
+
+Q_DECLARE_METATYPE(RecvLine)
+Q_DECLARE_METATYPE(DecodedBatch)
+
+class DecodeWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DecodeWorker(QObject *parent = nullptr);
+
+    static constexpr qint64 kPartialFlushMs = 300; // 没有换行的半行隔这么久才当作一行显示
+
+public slots:
+    void processPacket(const QByteArray &packet);
+    void reset(const QString &encodingName);
+    void setHexMode(bool on);
+    void setLineMode(bool on);
+    void setCollapse(bool enabled, bool ignoreDigits);
+    void setHighlightRules(const QStringList &specs);
+
+signals:
+    void batchReady(DecodedBatch batch);
+
+private:
+    void splitLines(const QByteArray &packet, qint64 nowMs, DecodedBatch &batch);
+    void appendHex(const QByteArray &packet, qint64 nowMs, DecodedBatch &batch);
+    bool routeAutoDetect(const QByteArray &packet, qint64 nowMs, DecodedBatch &batch);
+    void emitLine(const QString &text, qint64 nowMs, DecodedBatch &batch);
+
+    QStringDecoder m_decoder{QStringDecoder::Utf8};
+    QString m_carry;          // 尚未遇到换行符的半行（已解码）
+    bool m_pendingCr = false; // 上一包以 '\r' 结尾，下一包开头的 '\n' 属于同一个换行
+    qint64 m_lastFlushMs = 0;
+    bool m_hexMode = false;
+    bool m_lineMode = false;
+    bool m_autoDetect = false;
+    StreamClassifier m_classifier;
+    StreamClassifier::Kind m_decoderKind = StreamClassifier::TextUtf8;
+    LineCollapser m_collapser;
+    HighlightRuleSet m_highlight;
+};
+
+#endif // DECODEWORKER_H
@@ -0,0 +1,480 @@
+#include "derivedchannels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "channelregistry.h"
+
+class DerivedChannelSet::Parser
+{
+public:
+    Parser(const QString &text, Channel &ch)
+        : m_text(text)
+        , m_ch(ch)
+    {
+    }
+
+    bool parse(QString *error)
+    {
+        parseExpr();
+        skipSpace();
+        if (m_error.isEmpty() && m_pos < m_text.size()) fail(QString::fromUtf8(u8"多余的字符"));
+        if (!m_error.isEmpty()) {
+            if (error) *error = m_error;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static bool isIdentStart(QChar c) { return c.isLetter() || c == QLatin1Char('_') || c.unicode() >= 0x80; }
+    static bool isIdentChar(QChar c) { return isIdentStart(c) || c.isDigit(); }
+
+    void fail(const QString &message)
+    {
+        if (m_error.isEmpty()) m_error = QString::fromUtf8(u8"%1（位置 %2）").arg(message).arg(m_pos + 1);
+    }
+
+    void skipSpace()
+    {
+        while (m_pos < m_text.size() && m_text.at(m_pos).isSpace()) ++m_pos;
+    }
+
+    bool accept(QChar c)
+    {
+        skipSpace();
+        if (m_pos < m_text.size() && m_text.at(m_pos) == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(QChar c)
+    {
+        if (!accept(c)) fail(QString::fromUtf8(u8"缺少 '%1'").arg(c));
+    }
+
+    void push(Op::Kind kind, int depthDelta, int arg = 0, double value = 0.0)
+    {
+        Op op;
+        op.kind = kind;
+        op.arg = arg;
+        op.value = value;
+        m_ch.ops.push_back(op);
+        m_depth += depthDelta;
+        m_ch.maxDepth = std::max(m_ch.maxDepth, m_depth);
+    }
+
+    bool parseNumber(double &value)
+    {
+        skipSpace();
+        const int start = m_pos;
+        while (m_pos < m_text.size()) {
+            const QChar c = m_text.at(m_pos);
+            const bool exponentSign = (c == QLatin1Char('+') || c == QLatin1Char('-')) && m_pos > start
+                                      && (m_text.at(m_pos - 1) == QLatin1Char('e') || m_text.at(m_pos - 1) == QLatin1Char('E'));
+            if (!(c.isDigit() || c == QLatin1Char('.') || c == QLatin1Char('e') || c == QLatin1Char('E') || exponentSign)) break;
+            ++m_pos;
+        }
+        bool ok = false;
+        value = m_text.mid(start, m_pos - start).toDouble(&ok);
+        if (!ok) fail(QString::fromUtf8(u8"数字格式错误"));
+        return ok;
+    }
+
+    void parseExpr()
+    {
+        parseTerm();
+        while (m_error.isEmpty()) {
+            if (accept(QLatin1Char('+'))) {
+                parseTerm();
+                push(Op::Add, -1);
+            } else if (accept(QLatin1Char('-'))) {
+                parseTerm();
+                push(Op::Sub, -1);
+            } else {
+                break;
+            }
+        }
+    }
+
+    void parseTerm()
+    {
+        parseUnary();
+        while (m_error.isEmpty()) {
+            if (accept(QLatin1Char('*'))) {
+                parseUnary();
+                push(Op::Mul, -1);
+            } else if (accept(QLatin1Char('/'))) {
+                parseUnary();
+                push(Op::Div, -1);
+            } else {
+                break;
+            }
+        }
+    }
+
+    void parseUnary()
+    {
+        if (accept(QLatin1Char('-'))) {
+            parseUnary();
+            push(Op::Neg, 0);
+            return;
+        }
+        accept(QLatin1Char('+'));
+        parsePrimary();
+    }
+
+    void parsePrimary()
+    {
+        skipSpace();
+        if (m_pos >= m_text.size()) {
+            fail(QString::fromUtf8(u8"表达式不完整"));
+            return;
+        }
+        const QChar c = m_text.at(m_pos);
+        if (c == QLatin1Char('(')) {
+            ++m_pos;
+            parseExpr();
+            expect(QLatin1Char(')'));
+            return;
+        }
+        if (c.isDigit() || c == QLatin1Char('.')) {
+            double value = 0.0;
+            if (parseNumber(value)) push(Op::Const, 1, 0, value);
+            return;
+        }
+        if (!isIdentStart(c)) {
+            fail(QString::fromUtf8(u8"无法识别的字符 '%1'").arg(c));
+            return;
+        }
+
+        const int start = m_pos;
+        while (m_pos < m_text.size() && isIdentChar(m_text.at(m_pos))) ++m_pos;
+        // 数组字段展开的通道名，如 acc[0]
+        if (m_pos < m_text.size() && m_text.at(m_pos) == QLatin1Char('[')) {
+            const int close = m_text.indexOf(QLatin1Char(']'), m_pos);
+            if (close > m_pos) m_pos = close + 1;
+        }
+        const QString ident = m_text.mid(start, m_pos - start);
+
+        if (accept(QLatin1Char('('))) {
+            parseFunction(ident.toLower());
+            return;
+        }
+        if (ident == m_ch.name) {
+            fail(QString::fromUtf8(u8"不能引用自身"));
+            return;
+        }
+        int index = m_ch.inputs.indexOf(ident);
+        if (index < 0) {
+            m_ch.inputs << ident;
+            index = m_ch.inputs.size() - 1;
+        }
+        push(Op::Input, 1, index);
+    }
+
+    void parseFunction(const QString &fn)
+    {
+        if (fn == QLatin1String("abs") || fn == QLatin1String("sqrt")) {
+            parseExpr();
+            expect(QLatin1Char(')'));
+            push(fn == QLatin1String("abs") ? Op::Abs : Op::Sqrt, 0);
+        } else if (fn == QLatin1String("min") || fn == QLatin1String("max")) {
+            parseExpr();
+            expect(QLatin1Char(','));
+            parseExpr();
+            expect(QLatin1Char(')'));
+            push(fn == QLatin1String("min") ? Op::Min : Op::Max, -1);
+        } else if (fn == QLatin1String("avg")) {
+            parseExpr();
+            expect(QLatin1Char(','));
+            double window = 0.0;
+            if (!parseNumber(window) || window < 1 || window > 100000) {
+                fail(QString::fromUtf8(u8"avg 窗口应为 1~100000"));
+                return;
+            }
+            expect(QLatin1Char(')'));
+            AvgState state;
+            state.window.assign(static_cast<std::size_t>(window), 0.0);
+            m_ch.avg.push_back(state);
+            push(Op::Avg, 0, static_cast<int>(m_ch.avg.size()) - 1, window);
+        } else if (fn == QLatin1String("diff")) {
+            parseExpr();
+            expect(QLatin1Char(')'));
+            m_ch.diff.push_back(DiffState());
+            push(Op::Diff, 0, static_cast<int>(m_ch.diff.size()) - 1);
+        } else {
+            fail(QString::fromUtf8(u8"未知函数 %1").arg(fn));
+        }
+    }
+
+    const QString &m_text;
+    Channel &m_ch;
+    int m_pos = 0;
+    int m_depth = 0;
+    QString m_error;
+};
+
+bool DerivedChannelSet::compile(const QStringList &specs, DerivedChannelSet &set, QString *error,
+                                const QStringList &reserved)
+{
+    set = DerivedChannelSet();
+    for (int i = 0; i < specs.size(); ++i) {
+        const QString line = specs.at(i).trimmed();
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#'))) continue;
+        const int eq = line.indexOf(QLatin1Char('='));
+        Channel ch;
+        ch.name = line.left(eq).trimmed();
+        if (eq <= 0 || ch.name.isEmpty()) {
+            if (error) *error = QString::fromUtf8(u8"第 %1 行：应为 名称 = 表达式").arg(i + 1);
+            return false;
+        }
+        if (reserved.contains(ch.name)) {
+            if (error) *error = QString::fromUtf8(u8"第 %1 行：%2 与已有的提取通道重名").arg(i + 1).arg(ch.name);
+            return false;
+        }
+        for (const Channel &other : set.m_channels) {
+            if (other.name == ch.name) {
+                if (error) *error = QString::fromUtf8(u8"第 %1 行：%2 已在第 %3 行定义").arg(i + 1).arg(ch.name).arg(other.line);
+                return false;
+            }
+        }
+        ch.line = i + 1;
+        QString parseError;
+        const QString expr = line.mid(eq + 1);
+        if (!Parser(expr, ch).parse(&parseError)) {
+            if (error) *error = QString::fromUtf8(u8"第 %1 行：%2").arg(i + 1).arg(parseError);
+            return false;
+        }
+        if (ch.inputs.isEmpty()) {
+            if (error) *error = QString::fromUtf8(u8"第 %1 行：表达式没有引用任何通道").arg(i + 1);
+            return false;
+        }
+        set.m_channels.push_back(std::move(ch));
+    }
+    return set.sortByDependency(error);
+}
+
+QStringList DerivedChannelSet::outputNames() const
+{
+    QStringList names;
+    for (const Channel &ch : m_channels) names << ch.name;
+    return names;
+}
+
+bool DerivedChannelSet::sortByDependency(QString *error)
+{
+    // Kahn 拓扑排序：pending[i] 为通道 i 尚未排好的派生输入数
+    const int count = static_cast<int>(m_channels.size());
+    std::vector<int> pending(static_cast<std::size_t>(count), 0);
+    std::vector<std::vector<int>> dependents(static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        for (int j = 0; j < count; ++j) {
+            if (i != j && m_channels[static_cast<std::size_t>(i)].inputs.contains(m_channels[static_cast<std::size_t>(j)].name)) {
+                ++pending[static_cast<std::size_t>(i)];
+                dependents[static_cast<std::size_t>(j)].push_back(i);
+            }
+        }
+    }
+
+    std::vector<int> order;
+    order.reserve(static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        if (pending[static_cast<std::size_t>(i)] == 0) order.push_back(i);
+    }
+    for (std::size_t k = 0; k < order.size(); ++k) {
+        for (int d : dependents[static_cast<std::size_t>(order[k])]) {
+            if (--pending[static_cast<std::size_t>(d)] == 0) order.push_back(d);
+        }
+    }
+
+    if (static_cast<int>(order.size()) < count) {
+        // 剩下的通道都在环上或依赖环上的通道，列出它们便于定位
+        QStringList names;
+        int line = 0;
+        for (int i = 0; i < count; ++i) {
+            if (pending[static_cast<std::size_t>(i)] == 0) continue;
+            const Channel &ch = m_channels[static_cast<std::size_t>(i)];
+            if (line == 0) line = ch.line;
+            names << ch.name;
+        }
+        if (error) {
+            *error = QString::fromUtf8(u8"第 %1 行：派生通道循环依赖（%2）").arg(line).arg(names.join(QStringLiteral(", ")));
+        }
+        m_channels.clear();
+        return false;
+    }
+
+    std::vector<Channel> sorted;
+    sorted.reserve(static_cast<std::size_t>(count));
+    for (int i : order) sorted.push_back(std::move(m_channels[static_cast<std::size_t>(i)]));
+    m_channels = std::move(sorted);
+    return true;
+}
+
+void DerivedChannelSet::bind(ChannelRegistry *registry)
+{
+    for (Channel &ch : m_channels) {
+        ch.inputIds.clear();
+        for (const QString &input : std::as_const(ch.inputs)) {
+            ch.inputIds.push_back(registry->ensureChannel(input));
+        }
+        ch.outputId = registry->ensureChannel(ch.name);
+        const ChannelStore *clock = registry->channel(ch.inputIds.front());
+        ch.clockSeq = clock ? clock->totalCount() : 0;
+        // 其它输入从当前位置开始对齐，起点取已有的最新值
+        ch.inputSeq.assign(ch.inputIds.size(), 0);
+        ch.held.assign(ch.inputIds.size(), std::numeric_limits<double>::quiet_NaN());
+        for (std::size_t k = 1; k < ch.inputIds.size(); ++k) {
+            const ChannelStore *input = registry->channel(ch.inputIds[k]);
+            if (!input) continue;
+            qint64 t = 0;
+            input->latest(t, ch.held[k]);
+            ch.inputSeq[k] = input->totalCount();
+        }
+    }
+}
+
+bool DerivedChannelSet::evaluate(ChannelRegistry *registry)
+{
+    bool produced = false;
+    for (Channel &ch : m_channels) {
+        const ChannelStore *clock = registry->channel(ch.inputIds.front());
+        ChannelStore *out = registry->channel(ch.outputId);
+        if (!clock || !out) continue;
+
+        m_time.clear();
+        m_clock.clear();
+        ch.clockSeq = clock->readSince(ch.clockSeq, m_time, m_clock);
+        const int n = static_cast<int>(m_clock.size());
+        if (n == 0) continue;
+
+        if (m_inputs.size() < ch.inputIds.size()) m_inputs.resize(ch.inputIds.size());
+        for (std::size_t k = 1; k < ch.inputIds.size(); ++k) {
+            std::vector<double> &aligned = m_inputs[k];
+            aligned.resize(static_cast<std::size_t>(n));
+            const ChannelStore *input = registry->channel(ch.inputIds[k]);
+            m_inputTime.clear();
+            m_inputValues.clear();
+            const quint64 next = input ? input->readSince(ch.inputSeq[k], m_inputTime, m_inputValues) : ch.inputSeq[k];
+            // 按时间戳归并：时钟样本 i 取时间不晚于它的最近一个输入样本
+            const int m = static_cast<int>(m_inputValues.size());
+            int j = 0;
+            // 输入被清空过时旧值作废
+            double held = (next < ch.inputSeq[k]) ? std::numeric_limits<double>::quiet_NaN() : ch.held[k];
+            for (int i = 0; i < n; ++i) {
+                const qint64 t = m_time.at(i);
+                while (j < m && m_inputTime.at(j) <= t) held = m_inputValues.at(j++);
+                aligned[static_cast<std::size_t>(i)] = held;
+            }
+            ch.held[k] = held;
+            // 晚于最后一个时钟样本的输入留到下一轮再读
+            ch.inputSeq[k] = next - static_cast<quint64>(m - j);
+        }
+
+        run(ch, n);
+        out->append(m_time.constData(), m_regs.front().data(), n);
+        produced = true;
+    }
+    return produced;
+}
+
+void DerivedChannelSet::run(Channel &ch, int n)
+{
+    if (static_cast<int>(m_regs.size()) < ch.maxDepth) m_regs.resize(static_cast<std::size_t>(ch.maxDepth));
+    for (int r = 0; r < ch.maxDepth; ++r) m_regs[static_cast<std::size_t>(r)].resize(static_cast<std::size_t>(n));
+
+    // 每条指令是一个对整块数据的简单循环
+    int sp = 0;
+    for (const Op &op : ch.ops) {
+        double *top = (sp > 0) ? m_regs[static_cast<std::size_t>(sp - 1)].data() : nullptr;
+        double *below = (sp > 1) ? m_regs[static_cast<std::size_t>(sp - 2)].data() : nullptr;
+        switch (op.kind) {
+        case Op::Input: {
+            double *r = m_regs[static_cast<std::size_t>(sp++)].data();
+            if (op.arg == 0) {
+                std::copy(m_clock.constBegin(), m_clock.constEnd(), r);
+            } else {
+                const std::vector<double> &aligned = m_inputs[static_cast<std::size_t>(op.arg)];
+                std::copy(aligned.begin(), aligned.begin() + n, r);
+            }
+            break;
+        }
+        case Op::Const: {
+            double *r = m_regs[static_cast<std::size_t>(sp++)].data();
+            std::fill(r, r + n, op.value);
+            break;
+        }
+        case Op::Add:
+            for (int i = 0; i < n; ++i) below[i] += top[i];
+            --sp;
+            break;
+        case Op::Sub:
+            for (int i = 0; i < n; ++i) below[i] -= top[i];
+            --sp;
+            break;
+        case Op::Mul:
+            for (int i = 0; i < n; ++i) below[i] *= top[i];
+            --sp;
+            break;
+        case Op::Div:
+            for (int i = 0; i < n; ++i) below[i] /= top[i];
+            --sp;
+            break;
+        case Op::Min:
+            for (int i = 0; i < n; ++i) below[i] = top[i] < below[i] ? top[i] : below[i];
+            --sp;
+            break;
+        case Op::Max:
+            for (int i = 0; i < n; ++i) below[i] = top[i] > below[i] ? top[i] : below[i];
+            --sp;
+            break;
+        case Op::Neg:
+            for (int i = 0; i < n; ++i) top[i] = -top[i];
+            break;
+        case Op::Abs:
+            for (int i = 0; i < n; ++i) top[i] = std::fabs(top[i]);
+            break;
+        case Op::Sqrt:
+            for (int i = 0; i < n; ++i) top[i] = std::sqrt(top[i]);
+            break;
+        case Op::Avg: {
+            // 滑动平均带跨块状态，只能顺序计算；NaN 占窗口位置但不计入和，移出窗口后不再影响结果
+            AvgState &s = ch.avg[static_cast<std::size_t>(op.arg)];
+            const std::size_t window = s.window.size();
+            for (int i = 0; i < n; ++i) {
+                if (s.count == window) {
+                    const double old = s.window[s.pos];
+                    if (!std::isnan(old)) {
+                        s.sum -= old;
+                        --s.valid;
+                    }
+                } else {
+                    ++s.count;
+                }
+                const double x = top[i];
+                s.window[s.pos] = x;
+                if (!std::isnan(x)) {
+                    s.sum += x;
+                    ++s.valid;
+                }
+                s.pos = (s.pos + 1 == window) ? 0 : s.pos + 1;
+                top[i] = s.valid > 0 ? s.sum / static_cast<double>(s.valid) : std::numeric_limits<double>::quiet_NaN();
+            }
+            break;
+        }
+        case Op::Diff: {
+            // 相邻样本之差，首个样本输出 0
+            DiffState &s = ch.diff[static_cast<std::size_t>(op.arg)];
+            const double last = top[n - 1];
+            for (int i = n - 1; i > 0; --i) top[i] -= top[i - 1];
+            top[0] = s.valid ? top[0] - s.x : 0.0;
+            s.x = last;
+            s.valid = true;
+            break;
+        }
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef DERIVEDCHANNELS_H
+#define DERIVEDCHANNELS_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <vector>
+
+class ChannelRegistry;
+
+// 派生通道：用简单表达式由已有通道计算新的通道，例如
+//   power = volt * amp
+//   speed_kmh = speed * 3.6
+//   smooth = avg(temp, 20)
+//   rate = diff(count)          相邻样本之差
+// 支持 + - * /、括号、一元负号，函数 abs sqrt min max avg(x,N) diff(x)。
+// 表达式在设置确认时编译成后缀指令序列（批量求值计划），之后在提取线程上按块求值：
+// 每条指令对整块样本做一次简单循环，便于编译器向量化。
+// 表达式中第一个出现的通道作为时钟：它有新样本时才产生输出，
+// 其它通道按时间戳对齐，每个时钟样本取时间不晚于它的最近一个样本（还没有样本时为 NaN）。
+// 派生通道可以引用其它派生通道，编译时按依赖关系排序，循环依赖视为错误；
+// 输出名不能与提取/解码得到的通道重名，否则计算结果会写进源通道。
+class DerivedChannelSet
+{
+public:
+    // specs 每行 "名称 = 表达式"，reserved 为不能作为输出名的已有通道，出错时返回 false 并给出出错行
+    static bool compile(const QStringList &specs, DerivedChannelSet &set, QString *error,
+                        const QStringList &reserved = QStringList());
+
+    bool isEmpty() const { return m_channels.empty(); }
+    QStringList outputNames() const;
+
+    // 在注册表中登记输入/输出通道，并从当前位置开始计算（不回算历史数据）
+    void bind(ChannelRegistry *registry);
+
+    // 对各时钟通道的新样本求值并写入输出通道，有输出时返回 true
+    bool evaluate(ChannelRegistry *registry);
+
+private:
+    struct Op {
+        enum Kind { Input, Const, Add, Sub, Mul, Div, Min, Max, Neg, Abs, Sqrt, Avg, Diff };
+        Kind kind = Const;
+        int arg = 0;      // Input: 输入序号；Avg/Diff: 状态序号
+        double value = 0; // Const: 常数；Avg: 窗口长度
+    };
+
+    struct AvgState {
+        std::vector<double> window;
+        std::size_t pos = 0;
+        std::size_t count = 0; // 窗口中的样本数
+        std::size_t valid = 0; // 其中非 NaN 的个数，NaN 不计入 sum
+        double sum = 0.0;
+    };
+
+    struct DiffState {
+        bool valid = false;
+        double x = 0.0;
+    };
+
+    struct Channel {
+        QString name;
+        int line = 0;       // 在 specs 中的行号，用于报错
+        QStringList inputs; // inputs[0] 为时钟通道
+        std::vector<Op> ops;
+        int maxDepth = 0;
+        std::vector<int> inputIds;
+        int outputId = -1;
+        quint64 clockSeq = 0;
+        std::vector<quint64> inputSeq; // 非时钟输入下一次读取的序号（下标 0 不用）
+        std::vector<double> held;      // 非时钟输入已对齐到的最近样本值
+        std::vector<AvgState> avg;
+        std::vector<DiffState> diff;
+    };
+
+    class Parser;
+
+    bool sortByDependency(QString *error); // 被依赖的派生通道排在前面，同一轮求值即可得到上游的新样本
+    void run(Channel &ch, int n);
+
+    std::vector<Channel> m_channels;
+
+    // 求值用的复用缓冲
+    QVector<qint64> m_time;
+    QVector<double> m_clock;
+    QVector<qint64> m_inputTime;
+    QVector<double> m_inputValues;
+    std::vector<std::vector<double>> m_inputs; // 对齐到时钟样本的各输入值
+    std::vector<std::vector<double>> m_regs;
+};
+
+#endif // DERIVEDCHANNELS_H
@@ -0,0 +1,378 @@
+#include "extractrules.h"
+
+#include "numericscanner.h"
+
+#include <algorithm>
+
+namespace {
+QRegularExpression compileRule(const QString &pattern, QRegularExpression::PatternOptions options = {})
+{
+    QRegularExpression re(pattern, options);
+    if (re.isValid()) {
+        re.optimize(); // 立即完成 JIT 编译，避免首个数据包时再编译
+    }
+    return re;
+}
+
+QString firstCaptureOrWhole(const QRegularExpressionMatch &m)
+{
+    return (m.lastCapturedIndex() >= 1) ? m.captured(1) : m.captured(0);
+}
+
+// 单次扫描最多取的数值个数（栈上缓冲），满了从停下的位置继续扫描，不会丢值
+constexpr std::size_t kScanCapacity = 256;
+
+// 反复调用 scan 直到整段输入用完，每批结果交给 sink；scan 返回 false 表示输入不合格
+template <typename T, typename Scan, typename Sink>
+bool scanAll(const char *p, std::size_t n, Scan scan, Sink sink)
+{
+    T buf[kScanCapacity];
+    while (n > 0) {
+        std::size_t used = n;
+        std::size_t got = 0;
+        if (!scan(p, n, buf, &got, &used)) return false;
+        sink(buf, got);
+        if (got < kScanCapacity || used == 0 || used >= n) break;
+        p += used;
+        n -= used;
+    }
+    return true;
+}
+
+bool scanNumbers(const char *p, std::size_t n, double *buf, std::size_t *got, std::size_t *used)
+{
+    *got = NumericScanner::scanNumbers(p, n, buf, kScanCapacity, used);
+    return true;
+}
+
+bool scanNumbersWithExponent(const char *p, std::size_t n, double *buf, std::size_t *got, std::size_t *used)
+{
+    *got = NumericScanner::scanNumbers(p, n, buf, kScanCapacity, used, true);
+    return true;
+}
+
+bool scanCsv(const char *p, std::size_t n, double *buf, std::size_t *got, std::size_t *used)
+{
+    bool ok = false;
+    *got = NumericScanner::scanCsv(p, n, buf, kScanCapacity, ',', &ok, used);
+    return ok;
+}
+
+bool scanKeyValues(const char *p, std::size_t n, NumericScanner::KeyValue *buf, std::size_t *got, std::size_t *used)
+{
+    *got = NumericScanner::scanKeyValues(p, n, buf, kScanCapacity, used);
+    return true;
+}
+
+bool isCandidate(const ExtractRuleSet::Candidates &candidates, int id)
+{
+    return id < 0 || id >= static_cast<int>(candidates.size()) || candidates[id];
+}
+} // namespace
+
+int ExtractRuleSet::addToPrefilter(const QRegularExpression &re)
+{
+    const QByteArray pattern = re.pattern().toUtf8();
+    if (re.patternOptions() & QRegularExpression::CaseInsensitiveOption) {
+        return -1; // 不参与预筛，始终执行
+    }
+    return m_prefilter.addRule(std::string(pattern.constData(), static_cast<std::size_t>(pattern.size())));
+}
+
+int ExtractRuleSet::addChannelName(const QString &name)
+{
+    const int existing = m_channelNames.indexOf(name);
+    if (existing >= 0) return existing;
+    m_channelNames << name;
+    return m_channelNames.size() - 1;
+}
+
+ExtractRuleSet::Ptr ExtractRuleSet::build(const ExtractSettings &settings)
+{
+    auto rules = std::make_shared<ExtractRuleSet>();
+    rules->m_useWave = settings.useWave;
+    static const QString defaultWavePattern = QStringLiteral("(-?\\d+(?:\\.\\d+)?)");
+    for (const QString &pattern : settings.waveRegexList) {
+        const QString trimmed = pattern.trimmed();
+        if (trimmed.isEmpty()) continue;
+        WaveRule rule;
+        if (trimmed == defaultWavePattern || trimmed == numbersKeyword()) {
+            rule.kind = WaveRule::Numbers;
+            rule.exponent = (trimmed == numbersKeyword()); // 默认正则不认指数，快速路径保持同样的结果
+        } else if (trimmed == csvKeyword()) {
+            rule.kind = WaveRule::Csv;
+        } else if (trimmed.startsWith(csvKeyword() + QLatin1Char(':'))) {
+            // @csv:temp,hum,press 按列名写入通道，空列名表示跳过该列
+            rule.kind = WaveRule::Csv;
+            rule.named = true;
+            const QStringList columns = trimmed.mid(csvKeyword().size() + 1).split(',');
+            for (const QString &column : columns) {
+                const QString name = column.trimmed();
+                rule.channels.append(name.isEmpty() ? -1 : rules->addChannelName(name));
+            }
+        } else if (trimmed == keyValueKeyword()) {
+            rule.kind = WaveRule::KeyValue;
+            rule.named = true;
+        } else {
+            rule.re = compileRule(pattern);
+            if (!rule.re.isValid()) continue;
+            rule.prefilterId = rules->addToPrefilter(rule.re);
+            const QStringList groups = rule.re.namedCaptureGroups();
+            for (int g = 0; g < groups.size(); ++g) {
+                const bool hasName = (g > 0 && !groups.at(g).isEmpty());
+                rule.channels.append(hasName ? rules->addChannelName(groups.at(g)) : -1);
+                rule.named = rule.named || hasName;
+            }
+        }
+        rules->m_hasChannelRules = rules->m_hasChannelRules || rule.named;
+        rules->m_wave.append(rule);
+    }
+
+    rules->m_useAtt = settings.useAtt;
+    if (!settings.attRegex.isEmpty()) {
+        rules->m_att = compileRule(settings.attRegex);
+        rules->m_hasAttRegex = rules->m_att.isValid();
+        if (rules->m_hasAttRegex) rules->m_attPrefilterId = rules->addToPrefilter(rules->m_att);
+    }
+
+    const QString enableSpec = settings.customEnableSpec.trimmed();
+    if (!settings.customRegexList.isEmpty() && enableSpec != QStringLiteral("0")) {
+        QVector<int> enabled = parseIndexSpec(enableSpec, settings.customRegexList.size());
+        if (enabled.isEmpty()) {
+            enabled.reserve(settings.customRegexList.size());
+            for (int i = 0; i < settings.customRegexList.size(); ++i) enabled.append(i + 1);
+        }
+        for (int idx : enabled) {
+            const QString pattern = settings.customRegexList.value(idx - 1).trimmed();
+            if (pattern.isEmpty()) continue;
+            CustomRule rule;
+            rule.number = idx;
+            rule.re = compileRule(pattern, QRegularExpression::MultilineOption);
+            if (!rule.re.isValid()) continue;
+            rule.prefilterId = rules->addToPrefilter(rule.re);
+            rules->m_custom.append(rule);
+        }
+    }
+    rules->m_prefilter.build();
+    return rules;
+}
+
+QVector<int> ExtractRuleSet::parseIndexSpec(const QString &spec, int maxCount)
+{
+    QVector<int> result;
+    const QStringList tokens = spec.split(',', Qt::SkipEmptyParts);
+    for (QString token : tokens) {
+        token = token.trimmed();
+        if (token.contains('-')) {
+            const QStringList parts = token.split('-', Qt::SkipEmptyParts);
+            if (parts.size() == 2) {
+                bool ok1 = false, ok2 = false;
+                int a = parts.at(0).toInt(&ok1);
+                int b = parts.at(1).toInt(&ok2);
+                if (ok1 && ok2) {
+                    if (a > b) std::swap(a, b);
+                    for (int i = a; i <= b; ++i) {
+                        if (i >= 1 && i <= maxCount) result.append(i);
+                    }
+                }
+            }
+        } else {
+            bool ok = false;
+            int v = token.toInt(&ok);
+            if (ok && v >= 1 && v <= maxCount) result.append(v);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+void ExtractRuleSet::prescan(const QByteArray &utf8, Candidates &candidates) const
+{
+    m_prefilter.scan(utf8.constData(), static_cast<std::size_t>(utf8.size()), candidates);
+}
+
+bool ExtractRuleSet::parseWave(const QString &text, const QByteArray &utf8, const Candidates &candidates,
+                               QVector<double> &values) const
+{
+    values.clear();
+    if (!waveEnabled()) return false;
+
+    const char *bytes = utf8.constData();
+    const std::size_t size = static_cast<std::size_t>(utf8.size());
+    auto appendValues = [&values](const double *buf, std::size_t n) {
+        values.append(buf, static_cast<qsizetype>(n));
+    };
+    for (const WaveRule &rule : m_wave) {
+        if (rule.named) continue;
+        switch (rule.kind) {
+        case WaveRule::Numbers:
+            scanAll<double>(bytes, size, rule.exponent ? scanNumbersWithExponent : scanNumbers, appendValues);
+            break;
+        case WaveRule::Csv:
+            if (!scanAll<double>(bytes, size, scanCsv, appendValues)) values.clear(); // 有非数字列时整行不取
+            break;
+        case WaveRule::KeyValue:
+            scanAll<NumericScanner::KeyValue>(bytes, size, scanKeyValues,
+                                              [&values](const NumericScanner::KeyValue *kv, std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i) values.append(kv[i].value);
+            });
+            break;
+        case WaveRule::Regex: {
+            if (!isCandidate(candidates, rule.prefilterId)) break;
+            QRegularExpressionMatchIterator it = rule.re.globalMatch(text);
+            while (it.hasNext()) {
+                bool ok = false;
+                const double v = firstCaptureOrWhole(it.next()).toDouble(&ok);
+                if (ok) values.append(v);
+            }
+            break;
+        }
+        }
+        if (!values.isEmpty()) return true;
+    }
+    return false;
+}
+
+void ExtractRuleSet::parseChannels(const QString &text, const QByteArray &utf8, const Candidates &candidates,
+                                   QVector<ChannelHit> &hits) const
+{
+    hits.clear();
+    if (!channelsEnabled()) return;
+
+    const char *bytes = utf8.constData();
+    const std::size_t size = static_cast<std::size_t>(utf8.size());
+    for (const WaveRule &rule : m_wave) {
+        if (!rule.named) continue;
+        switch (rule.kind) {
+        case WaveRule::Csv: {
+            // 列序号跨批累计；有非数字列时撤回本规则已加入的结果
+            const qsizetype before = hits.size();
+            qsizetype column = 0;
+            const bool ok = scanAll<double>(bytes, size, scanCsv, [&](const double *buf, std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i, ++column) {
+                    const int channel = column < rule.channels.size() ? rule.channels.at(column) : -1;
+                    if (channel >= 0) hits.append({channel, nullptr, 0, buf[i]});
+                }
+            });
+            if (!ok) hits.resize(before);
+            break;
+        }
+        case WaveRule::KeyValue:
+            scanAll<NumericScanner::KeyValue>(bytes, size, scanKeyValues,
+                                              [&hits](const NumericScanner::KeyValue *kv, std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    hits.append({-1, kv[i].key, static_cast<int>(kv[i].keyLen), kv[i].value});
+                }
+            });
+            break;
+        case WaveRule::Regex: {
+            if (!isCandidate(candidates, rule.prefilterId)) break;
+            QRegularExpressionMatchIterator it = rule.re.globalMatch(text);
+            while (it.hasNext()) {
+                const QRegularExpressionMatch m = it.next();
+                for (int g = 1; g < rule.channels.size(); ++g) {
+                    const int channel = rule.channels.at(g);
+                    if (channel < 0 || m.capturedStart(g) < 0) continue;
+                    bool ok = false;
+                    const double v = m.capturedView(g).toDouble(&ok);
+                    if (ok) hits.append({channel, nullptr, 0, v});
+                }
+            }
+            break;
+        }
+        case WaveRule::Numbers:
+            break;
+        }
+    }
+}
+
+bool ExtractRuleSet::parseAttitude(const QString &text, const QByteArray &utf8, const Candidates &candidates,
+                                   double &roll, double &pitch, double &yaw) const
+{
+    if (!m_useAtt) return false;
+    const QString str = text.trimmed();
+    if (m_hasAttRegex && isCandidate(candidates, m_attPrefilterId)) {
+        const QRegularExpressionMatch m = m_att.match(str);
+        if (m.hasMatch() && m.lastCapturedIndex() >= 3) {
+            bool ok1 = false, ok2 = false, ok3 = false;
+            const double r = m.captured(1).toDouble(&ok1);
+            const double p = m.captured(2).toDouble(&ok2);
+            const double y = m.captured(3).toDouble(&ok3);
+            if (ok1 && ok2 && ok3) {
+                roll = r; pitch = p; yaw = y;
+                return true;
+            }
+        }
+    }
+    // 无正则或未命中时按 "r,p,y" 逗号格式解析
+    double v[4];
+    bool ok = false;
+    const std::size_t n = NumericScanner::scanCsv(utf8.constData(), static_cast<std::size_t>(utf8.size()),
+                                                  v, 4, ',', &ok);
+    if (!ok || n != 3) return false;
+    roll = v[0];
+    pitch = v[1];
+    yaw = v[2];
+    return true;
+}
+
+void ExtractRuleSet::parseAttitudeBlock(const QString &text, const QByteArray &utf8, const Candidates &candidates,
+                                        QVector<double> &rpy) const
+{
+    rpy.clear();
+    if (!m_useAtt) return;
+    if (m_hasAttRegex && isCandidate(candidates, m_attPrefilterId)) {
+        QRegularExpressionMatchIterator it = m_att.globalMatch(text);
+        while (it.hasNext()) {
+            const QRegularExpressionMatch m = it.next();
+            if (m.lastCapturedIndex() < 3) continue;
+            bool ok1 = false, ok2 = false, ok3 = false;
+            const double r = m.captured(1).toDouble(&ok1);
+            const double p = m.captured(2).toDouble(&ok2);
+            const double y = m.captured(3).toDouble(&ok3);
+            if (ok1 && ok2 && ok3) rpy << r << p << y;
+        }
+        if (!rpy.isEmpty()) return;
+    }
+    // 逗号格式：每个空白分隔的片段是一组 "r,p,y"
+    const char *p = utf8.constData();
+    const char *const end = p + utf8.size();
+    auto isSpace = [](char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; };
+    while (p < end) {
+        while (p < end && isSpace(*p)) ++p;
+        const char *tokenStart = p;
+        while (p < end && !isSpace(*p)) ++p;
+        if (p == tokenStart) break;
+        double v[4];
+        bool ok = false;
+        const std::size_t n = NumericScanner::scanCsv(tokenStart, static_cast<std::size_t>(p - tokenStart), v, 4, ',', &ok);
+        if (ok && n == 3) rpy << v[0] << v[1] << v[2];
+    }
+}
+
+QStringList ExtractRuleSet::matchCustom(const QString &text, const Candidates &candidates, QVector<int> *rules) const
+{
+    QStringList hits;
+    for (int r = 0; r < m_custom.size(); ++r) {
+        const CustomRule &rule = m_custom.at(r);
+        if (!isCandidate(candidates, rule.prefilterId)) continue;
+        QRegularExpressionMatchIterator it = rule.re.globalMatch(text);
+        while (it.hasNext()) {
+            const QString captured = firstCaptureOrWhole(it.next());
+            if (captured.isEmpty()) continue;
+            hits << captured;
+            if (rules) rules->append(r);
+        }
+    }
+    return hits;
+}
+
+QStringList ExtractRuleSet::customLabels() const
+{
+    QStringList labels;
+    for (const CustomRule &rule : m_custom) {
+        labels << QString::fromUtf8(u8"匹配 %1: %2").arg(rule.number).arg(rule.re.pattern());
+    }
+    return labels;
+}
@@ -0,0 +1,108 @@
+#ifndef EXTRACTRULES_H
+#define EXTRACTRULES_H
+
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+#include <vector>
+#include "patternprefilter.h"
+
+// 提取规则的用户配置（格式设置弹窗的内容）
+struct ExtractSettings {
+    bool useWave = false;
+    QStringList waveRegexList;
+    bool useAtt = false;
+    QString attRegex;
+    QStringList customRegexList;
+    QString customEnableSpec;
+};
+
+// 编译后的提取规则集：设置确认时构建一次（PCRE2 JIT 优化、启用序号预先解析），
+// 构建后只读，可以在多个线程间共享；设置变化时整体替换指针。
+// 所有正则规则共用一个字面量预筛，文本先 prescan 一遍，再只对候选规则跑正则。
+class ExtractRuleSet
+{
+public:
+    using Ptr = std::shared_ptr<const ExtractRuleSet>;
+
+    static Ptr build(const ExtractSettings &settings);
+    static QVector<int> parseIndexSpec(const QString &spec, int maxCount);
+
+    bool waveEnabled() const { return m_useWave && !m_wave.isEmpty(); }
+    bool attitudeEnabled() const { return m_useAtt; }
+    bool customEnabled() const { return !m_custom.isEmpty(); }
+
+    // 命名通道的一个取值：channel >= 0 时为 channelNames() 中的序号，
+    // 否则为 @kv 的动态键（key 指向传入的 utf8 字节，调用期间有效）
+    struct ChannelHit {
+        int channel = -1;
+        const char *key = nullptr;
+        int keyLen = 0;
+        double value = 0.0;
+    };
+
+    // 预筛结果：下标为规则在预筛中的序号，非 0 表示需要执行该正则
+    using Candidates = std::vector<char>;
+    void prescan(const QByteArray &utf8, Candidates &candidates) const;
+
+    // utf8 为同一段文本的 UTF-8 字节，供预筛和免正则的快速扫描路径使用
+    bool parseWave(const QString &text, const QByteArray &utf8, const Candidates &candidates,
+                   QVector<double> &values) const;
+    bool parseAttitude(const QString &text, const QByteArray &utf8, const Candidates &candidates,
+                       double &roll, double &pitch, double &yaw) const;
+    // 无换行数据流强制切出的块中可能有多组姿态：正则逐个匹配，逗号格式按空白分隔的片段逐个解析，
+    // 每组三个值依次写入 rpy
+    void parseAttitudeBlock(const QString &text, const QByteArray &utf8, const Candidates &candidates,
+                            QVector<double> &rpy) const;
+    // rules 非空时为每个命中追加所属规则在 customLabels() 中的序号
+    QStringList matchCustom(const QString &text, const Candidates &candidates, QVector<int> *rules = nullptr) const;
+    QStringList customLabels() const; // 各条启用的自定义规则的显示名，如 "匹配 2: temp=(\d+)"
+
+    // 命名通道规则：带命名捕获组的正则、带列名的 @csv:名1,名2,...、@kv。
+    // 这些规则不参与 parseWave 的单通道输出，各自写入对应通道。
+    bool channelsEnabled() const { return m_useWave && m_hasChannelRules; }
+    const QStringList &channelNames() const { return m_channelNames; }
+    void parseChannels(const QString &text, const QByteArray &utf8, const Candidates &candidates,
+                       QVector<ChannelHit> &hits) const;
+
+    // 波形规则写成以下关键字时走 NumericScanner，不经过正则引擎；
+    // 默认规则 (-?\d+(?:\.\d+)?) 走同一路径，但只有 @numbers 接受指数写法
+    static QString numbersKeyword() { return QStringLiteral("@numbers"); }
+    static QString csvKeyword() { return QStringLiteral("@csv"); }
+    static QString keyValueKeyword() { return QStringLiteral("@kv"); }
+
+private:
+    struct WaveRule {
+        enum Kind { Regex, Numbers, Csv, KeyValue };
+        Kind kind = Regex;
+        QRegularExpression re;
+        int prefilterId = -1;
+        QVector<int> channels; // 捕获组号或 CSV 列号 -> 通道序号（-1 表示不输出）
+        bool named = false;
+        bool exponent = false; // Numbers：接受 1e-3 这样的指数写法
+    };
+
+    struct CustomRule {
+        QRegularExpression re;
+        int prefilterId = -1;
+        int number = 0; // 在自定义规则列表中的序号（从 1 开始，与启用列表一致）
+    };
+
+    int addToPrefilter(const QRegularExpression &re);
+    int addChannelName(const QString &name);
+
+    bool m_useWave = false;
+    bool m_useAtt = false;
+    QVector<WaveRule> m_wave;
+    QStringList m_channelNames;
+    bool m_hasChannelRules = false;
+    QRegularExpression m_att;
+    bool m_hasAttRegex = false;
+    int m_attPrefilterId = -1;
+    QVector<CustomRule> m_custom; // 仅包含已启用的规则
+    PatternPrefilter m_prefilter;
+};
+
+#endif // EXTRACTRULES_H
@@ -0,0 +1,241 @@
+#include "extractworker.h"
+
+#include <QTimer>
+#include "attitudeworker.h"
+#include "channelregistry.h"
+
+namespace {
+// 无换行数据流中可以切开的位置：';' 或两侧都不挨着逗号的空白。
+// "1,2,3 4,5,6" 在空格处切，"1, 2, 3" 中的空白属于同一组数值，不切
+bool isRecordSeparator(const QString &text, qsizetype i)
+{
+    const QChar c = text.at(i);
+    if (c == QLatin1Char(';')) return true;
+    if (!c.isSpace()) return false;
+    qsizetype l = i - 1;
+    while (l >= 0 && text.at(l).isSpace()) --l;
+    qsizetype r = i + 1;
+    while (r < text.size() && text.at(r).isSpace()) ++r;
+    const bool commaLeft = l >= 0 && text.at(l) == QLatin1Char(',');
+    const bool commaRight = r < text.size() && text.at(r) == QLatin1Char(',');
+    return !commaLeft && !commaRight;
+}
+} // namespace
+
+ExtractWorker::ExtractWorker(QObject *parent)
+    : QObject(parent)
+{
+    // 作为子对象随 moveToThread 一起移到工作线程
+    m_carryTimer = new QTimer(this);
+    m_carryTimer->setSingleShot(true);
+    m_carryTimer->setInterval(kCarryIdleMs);
+    connect(m_carryTimer, &QTimer::timeout, this, &ExtractWorker::flushCarry);
+}
+
+void ExtractWorker::setSinks(AttitudeWorker *att)
+{
+    m_attSink = att;
+}
+
+void ExtractWorker::setChannelRegistry(ChannelRegistry *registry)
+{
+    m_registry = registry;
+    if (!m_registry) return;
+    connect(m_registry, &ChannelRegistry::sourcesAppended,
+            this, &ExtractWorker::evaluateDerived, Qt::QueuedConnection);
+    // 未命名的波形规则和姿态解析也各自登记为通道
+    m_waveChannelId = m_registry->ensureChannel(QStringLiteral("wave"));
+    m_attChannelIds[0] = m_registry->ensureChannel(QStringLiteral("roll"));
+    m_attChannelIds[1] = m_registry->ensureChannel(QStringLiteral("pitch"));
+    m_attChannelIds[2] = m_registry->ensureChannel(QStringLiteral("yaw"));
+}
+
+void ExtractWorker::resolveChannels(const ExtractRuleSet::Ptr &rules)
+{
+    if (m_resolvedRules == rules) return;
+    m_resolvedRules = rules;
+    m_ruleChannelIds.clear();
+    for (const QString &name : rules->channelNames()) {
+        m_ruleChannelIds.push_back(m_registry->ensureChannel(name));
+    }
+}
+
+int ExtractWorker::keyChannel(const char *key, int keyLen)
+{
+    // fromRawData 不复制数据，只在首次出现的键上分配
+    const QByteArray probe = QByteArray::fromRawData(key, keyLen);
+    const auto it = m_keyChannelIds.constFind(probe);
+    if (it != m_keyChannelIds.constEnd()) return it.value();
+    // 与派生通道同名的键不写入，免得和计算结果混在同一个通道里（记为 -1）
+    const QString name = QString::fromUtf8(key, keyLen);
+    const std::shared_ptr<DerivedChannelSet> derived = std::atomic_load(&m_pendingDerived);
+    const int id = (derived && derived->outputNames().contains(name)) ? -1 : m_registry->ensureChannel(name);
+    m_keyChannelIds.insert(QByteArray(key, keyLen), id);
+    return id;
+}
+
+void ExtractWorker::setRules(const ExtractRuleSet::Ptr &rules)
+{
+    std::atomic_store(&m_rules, rules);
+}
+
+void ExtractWorker::setDerivedChannels(std::shared_ptr<DerivedChannelSet> derived)
+{
+    const bool enabled = derived != nullptr;
+    std::atomic_store(&m_pendingDerived, std::move(derived));
+    if (!m_registry) return;
+    m_registry->setDerivedStage(enabled);
+    QMetaObject::invokeMethod(this, &ExtractWorker::evaluateDerived, Qt::QueuedConnection); // 在本线程上绑定
+}
+
+void ExtractWorker::evaluateDerived()
+{
+    if (!m_registry) return;
+    const std::shared_ptr<DerivedChannelSet> pending = std::atomic_load(&m_pendingDerived);
+    if (pending != m_derived) {
+        m_derived = pending;
+        m_keyChannelIds.clear(); // 派生通道名变了，键值通道重新按名称查找
+        if (m_derived) m_derived->bind(m_registry);
+    }
+    // 派生通道已按依赖排序，一轮即可算完；源数据和派生输出一起只通知订阅者一次
+    if (m_derived && !m_derived->isEmpty()) m_derived->evaluate(m_registry);
+    m_registry->publishAppended();
+}
+
+void ExtractWorker::reset()
+{
+    m_lineCarry.clear();
+    m_carryTimer->stop();
+}
+
+void ExtractWorker::flushCarry()
+{
+    const ExtractRuleSet::Ptr rules = std::atomic_load(&m_rules);
+    if (!rules || m_lineCarry.isEmpty()) return;
+    if (m_registry && rules->channelsEnabled()) resolveChannels(rules);
+    m_batchHits.clear();
+    m_batchHitRules.clear();
+    m_appended = false;
+    const QString line = m_lineCarry;
+    m_lineCarry.clear();
+    processLine(*rules, line, m_carryTs);
+    if (m_appended) m_registry->notifyAppended();
+    if (rules->customEnabled()) {
+        if (!m_batchHits.isEmpty() || !m_lastHitsEmpty) emit customMatches(m_batchHits, m_batchHitRules);
+        m_lastHitsEmpty = m_batchHits.isEmpty();
+    }
+}
+
+void ExtractWorker::processBatch(const DecodedBatch &batch)
+{
+    const ExtractRuleSet::Ptr rules = std::atomic_load(&m_rules);
+    if (!rules || batch.text.isEmpty()) return;
+    if (m_registry && rules->channelsEnabled()) resolveChannels(rules);
+
+    // 按完整行提取，半行留到下一批，与显示模式（HEX/自动换行/折叠）无关
+    m_batchHits.clear();
+    m_batchHitRules.clear();
+    m_appended = false;
+    const qint64 ts = batch.timestampMs;
+    const QString &text = batch.text;
+    qsizetype start = 0;
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        const QChar c = text.at(i);
+        if (c != QLatin1Char('\n') && c != QLatin1Char('\r')) continue;
+        if (m_lineCarry.isEmpty()) {
+            processLine(*rules, text.mid(start, i - start), ts);
+        } else {
+            m_lineCarry += QStringView(text).mid(start, i - start);
+            processLine(*rules, m_lineCarry, ts);
+            m_lineCarry.clear();
+        }
+        start = i + 1;
+    }
+    if (start < text.size()) m_lineCarry += QStringView(text).mid(start);
+    if (m_lineCarry.size() > kMaxCarry) {
+        // 没有换行的数据流按块提取，避免无限累积：在最后一个记录分隔处切开，
+        // 不把一个数或一组 "r,p,y" 切成两半，切点之后的部分继续留作半行
+        qsizetype cut = m_lineCarry.size() - 1;
+        while (cut >= 0 && !isRecordSeparator(m_lineCarry, cut)) --cut;
+        if (cut <= 0) {
+            processLine(*rules, m_lineCarry, ts, true); // 整块没有分隔符，只能整体提取
+            m_lineCarry.clear();
+        } else {
+            processLine(*rules, m_lineCarry.left(cut), ts, true);
+            m_lineCarry.remove(0, cut + 1);
+        }
+    }
+    // 剩下的半行若迟迟等不到换行（提示符、末尾没有换行的最后一行），空闲超时后按完整行提取
+    m_carryTs = ts;
+    if (m_lineCarry.isEmpty()) m_carryTimer->stop();
+    else m_carryTimer->start();
+
+    if (m_appended) m_registry->notifyAppended();
+
+    if (rules->customEnabled()) {
+        // 连续无命中时不重复通知界面
+        if (!m_batchHits.isEmpty() || !m_lastHitsEmpty) {
+            emit customMatches(m_batchHits, m_batchHitRules);
+        }
+        m_lastHitsEmpty = m_batchHits.isEmpty();
+    }
+}
+
+void ExtractWorker::processLine(const ExtractRuleSet &rules, const QString &line, qint64 ts, bool block)
+{
+    const QString raw = line.trimmed();
+    if (raw.isEmpty()) return;
+    // 每行只转换一次 UTF-8，数值扫描直接在字节上进行
+    const QByteArray utf8 = raw.toUtf8();
+    // 所有正则规则共用一次字面量预筛，之后只执行可能命中的规则
+    rules.prescan(utf8, m_candidates);
+
+    if (rules.waveEnabled() && rules.parseWave(raw, utf8, m_candidates, m_values)) {
+        if (m_registry) {
+            for (double v : std::as_const(m_values)) m_registry->append(m_waveChannelId, ts, v);
+            m_appended = true;
+        }
+    }
+
+    if (m_registry && rules.channelsEnabled()) {
+        rules.parseChannels(raw, utf8, m_candidates, m_hits);
+        for (const ExtractRuleSet::ChannelHit &hit : std::as_const(m_hits)) {
+            const int id = (hit.channel >= 0) ? m_ruleChannelIds[static_cast<std::size_t>(hit.channel)]
+                                              : keyChannel(hit.key, hit.keyLen);
+            if (id >= 0) m_registry->append(id, ts, hit.value);
+        }
+        m_appended = m_appended || !m_hits.isEmpty();
+    }
+
+    // 姿态显示只由解析结果更新，避免原始文本闪烁；每行一个样本，一批内的样本全部入通道
+    if (rules.attitudeEnabled() && block) {
+        rules.parseAttitudeBlock(raw, utf8, m_candidates, m_attValues);
+        for (qsizetype i = 0; i + 2 < m_attValues.size(); i += 3) {
+            const double r = m_attValues.at(i);
+            const double p = m_attValues.at(i + 1);
+            const double y = m_attValues.at(i + 2);
+            if (m_attSink) m_attSink->appendAttitude(r, p, y);
+            if (m_registry) {
+                m_registry->append(m_attChannelIds[0], ts, r);
+                m_registry->append(m_attChannelIds[1], ts, p);
+                m_registry->append(m_attChannelIds[2], ts, y);
+                m_appended = true;
+            }
+        }
+    } else if (rules.attitudeEnabled()) {
+        double r, p, y;
+        if (rules.parseAttitude(raw, utf8, m_candidates, r, p, y)) {
+            if (m_attSink) m_attSink->appendAttitude(r, p, y);
+            if (m_registry) {
+                m_registry->append(m_attChannelIds[0], ts, r);
+                m_registry->append(m_attChannelIds[1], ts, p);
+                m_registry->append(m_attChannelIds[2], ts, y);
+                m_appended = true;
+            }
+        }
+    }
+
+    if (rules.customEnabled()) {
+        m_batchHits += rules.matchCustom(raw, m_candidates, &m_batchHitRules);
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef EXTRACTWORKER_H
+#define EXTRACTWORKER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <vector>
+#include "decodeworker.h"
+#include "derivedchannels.h"
+#include "extractrules.h"
+
+class AttitudeWorker;
+class ChannelRegistry;
+class QTimer;
+
+// 提取阶段：在独立线程上消费解码后的批次，按规则集提取数值，
+// 直接写入通道注册表和姿态缓冲，波形等视图从注册表增量拉取，GUI 只接收整理好的结果。
+// 每个数据流（串口）一个实例、一个线程，多个串口时自然分摊到多个核。
+class ExtractWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ExtractWorker(QObject *parent = nullptr);
+
+    // 以下两个接口可在任意线程直接调用
+    void setSinks(AttitudeWorker *att);
+    void setChannelRegistry(ChannelRegistry *registry);
+    void setRules(const ExtractRuleSet::Ptr &rules);
+    void setDerivedChannels(std::shared_ptr<DerivedChannelSet> derived); // 交出后只在本线程使用
+
+public slots:
+    void processBatch(const DecodedBatch &batch);
+    void reset(); // 切换编码等场合丢弃未完成的半行
+    void evaluateDerived(); // 写入端一批数据写完后计算派生通道，再通知订阅者
+
+signals:
+    void customMatches(QStringList hits, QVector<int> rules); // rules[i] 为 hits[i] 所属的自定义规则序号
+
+private:
+    // block 为 true 时 line 是无换行数据流中强制切出的一块，可能含多组样本
+    void processLine(const ExtractRuleSet &rules, const QString &line, qint64 ts, bool block = false);
+    void flushCarry(); // 空闲超时：把半行当作完整的一行提取
+    void resolveChannels(const ExtractRuleSet::Ptr &rules);
+    int keyChannel(const char *key, int keyLen);
+
+    static constexpr int kMaxCarry = 4096;  // 半行超过该长度时在最后一个记录分隔处切出前一段提取
+    // 半行保持这么久没有新数据时按完整行提取，与解码阶段显示半行的阈值一致，
+    // 发送端行中停顿不超过该时间时不会把一个值拆成两个样本
+    static constexpr int kCarryIdleMs = static_cast<int>(DecodeWorker::kPartialFlushMs);
+
+    ExtractRuleSet::Ptr m_rules; // 只通过 std::atomic_load/atomic_store 访问
+    AttitudeWorker* m_attSink = nullptr;
+    bool m_lastHitsEmpty = true;
+    QString m_lineCarry; // 尚未遇到换行符的半行
+    qint64 m_carryTs = 0;
+    QTimer* m_carryTimer = nullptr;
+    QVector<double> m_attValues; // 复用的姿态数值缓冲（块模式）
+    QVector<double> m_values; // 复用的波形数值缓冲
+    QStringList m_batchHits;
+    QVector<int> m_batchHitRules;
+    bool m_appended = false;
+    ExtractRuleSet::Candidates m_candidates;
+
+    // 通道注册表及本线程的通道序号缓存
+    ChannelRegistry* m_registry = nullptr;
+    ExtractRuleSet::Ptr m_resolvedRules; // 持有引用，旧规则集释放后地址被新规则集复用也不会误判为已解析
+    std::vector<int> m_ruleChannelIds;  // ExtractRuleSet::channelNames() 序号 -> 注册表序号
+    QHash<QByteArray, int> m_keyChannelIds; // @kv 动态键 -> 注册表序号
+    int m_waveChannelId = -1;
+    int m_attChannelIds[3] = {-1, -1, -1};
+    QVector<ExtractRuleSet::ChannelHit> m_hits;
+
+    std::shared_ptr<DerivedChannelSet> m_pendingDerived; // 只通过 std::atomic_load/atomic_store 访问
+    std::shared_ptr<DerivedChannelSet> m_derived;
+};
+
+#endif // EXTRACTWORKER_H
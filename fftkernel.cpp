@@ -0,0 +1,143 @@
+#include "fftkernel.h"
+
+#include <cmath>
+#include <utility>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FFT_USE_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FFT_USE_SSE2 1
+#endif
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+
+// 一组蝶形：a[j] ± w[j]·b[j]，j = 0..h-1
+inline void butterflies(double *ar, double *ai, double *br, double *bi, const double *wr, const double *wi, int h)
+{
+    int j = 0;
+#if defined(FFT_USE_AVX)
+    for (; j + 4 <= h; j += 4) {
+        const __m256d xr = _mm256_loadu_pd(br + j);
+        const __m256d xi = _mm256_loadu_pd(bi + j);
+        const __m256d cr = _mm256_loadu_pd(wr + j);
+        const __m256d ci = _mm256_loadu_pd(wi + j);
+        const __m256d tr = _mm256_sub_pd(_mm256_mul_pd(xr, cr), _mm256_mul_pd(xi, ci));
+        const __m256d ti = _mm256_add_pd(_mm256_mul_pd(xr, ci), _mm256_mul_pd(xi, cr));
+        const __m256d ur = _mm256_loadu_pd(ar + j);
+        const __m256d ui = _mm256_loadu_pd(ai + j);
+        _mm256_storeu_pd(br + j, _mm256_sub_pd(ur, tr));
+        _mm256_storeu_pd(bi + j, _mm256_sub_pd(ui, ti));
+        _mm256_storeu_pd(ar + j, _mm256_add_pd(ur, tr));
+        _mm256_storeu_pd(ai + j, _mm256_add_pd(ui, ti));
+    }
+#elif defined(FFT_USE_SSE2)
+    for (; j + 2 <= h; j += 2) {
+        const __m128d xr = _mm_loadu_pd(br + j);
+        const __m128d xi = _mm_loadu_pd(bi + j);
+        const __m128d cr = _mm_loadu_pd(wr + j);
+        const __m128d ci = _mm_loadu_pd(wi + j);
+        const __m128d tr = _mm_sub_pd(_mm_mul_pd(xr, cr), _mm_mul_pd(xi, ci));
+        const __m128d ti = _mm_add_pd(_mm_mul_pd(xr, ci), _mm_mul_pd(xi, cr));
+        const __m128d ur = _mm_loadu_pd(ar + j);
+        const __m128d ui = _mm_loadu_pd(ai + j);
+        _mm_storeu_pd(br + j, _mm_sub_pd(ur, tr));
+        _mm_storeu_pd(bi + j, _mm_sub_pd(ui, ti));
+        _mm_storeu_pd(ar + j, _mm_add_pd(ur, tr));
+        _mm_storeu_pd(ai + j, _mm_add_pd(ui, ti));
+    }
+#endif
+    for (; j < h; ++j) {
+        const double tr = br[j] * wr[j] - bi[j] * wi[j];
+        const double ti = br[j] * wi[j] + bi[j] * wr[j];
+        br[j] = ar[j] - tr;
+        bi[j] = ai[j] - ti;
+        ar[j] += tr;
+        ai[j] += ti;
+    }
+}
+} // namespace
+
+RealFft::RealFft(int size)
+    : m_size(size)
+    , m_half(size / 2)
+{
+    const int m = m_half;
+    int bits = 0;
+    while ((1 << bits) < m) ++bits;
+    m_bitrev.resize(static_cast<std::size_t>(m));
+    for (int i = 0; i < m; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+        }
+        m_bitrev[static_cast<std::size_t>(i)] = r;
+    }
+
+    m_twRe.assign(static_cast<std::size_t>(m), 0.0);
+    m_twIm.assign(static_cast<std::size_t>(m), 0.0);
+    for (int h = 1; h < m; h <<= 1) {
+        for (int j = 0; j < h; ++j) {
+            const double a = -kPi * j / h;
+            m_twRe[static_cast<std::size_t>(h + j)] = std::cos(a);
+            m_twIm[static_cast<std::size_t>(h + j)] = std::sin(a);
+        }
+    }
+    m_splitRe.resize(static_cast<std::size_t>(m + 1));
+    m_splitIm.resize(static_cast<std::size_t>(m + 1));
+    for (int k = 0; k <= m; ++k) {
+        const double a = -2.0 * kPi * k / m_size;
+        m_splitRe[static_cast<std::size_t>(k)] = std::cos(a);
+        m_splitIm[static_cast<std::size_t>(k)] = std::sin(a);
+    }
+    m_re.resize(static_cast<std::size_t>(m));
+    m_im.resize(static_cast<std::size_t>(m));
+}
+
+void RealFft::transform()
+{
+    double *re = m_re.data();
+    double *im = m_im.data();
+    for (int i = 0; i < m_half; ++i) {
+        const int r = m_bitrev[static_cast<std::size_t>(i)];
+        if (r > i) {
+            std::swap(re[i], re[r]);
+            std::swap(im[i], im[r]);
+        }
+    }
+    for (int h = 1; h < m_half; h <<= 1) {
+        const double *wr = m_twRe.data() + h;
+        const double *wi = m_twIm.data() + h;
+        for (int k = 0; k < m_half; k += 2 * h) {
+            butterflies(re + k, im + k, re + k + h, im + k + h, wr, wi, h);
+        }
+    }
+}
+
+void RealFft::powerSpectrum(const double *in, double *power)
+{
+    // 偶数样本作实部、奇数样本作虚部
+    for (int i = 0; i < m_half; ++i) {
+        m_re[static_cast<std::size_t>(i)] = in[2 * i];
+        m_im[static_cast<std::size_t>(i)] = in[2 * i + 1];
+    }
+    transform();
+
+    // X[k] = E[k] + e^{-2πik/N}·O[k]，E/O 由 Z[k] 与 conj(Z[M-k]) 拆出
+    const int m = m_half;
+    for (int k = 0; k <= m; ++k) {
+        const std::size_t a = static_cast<std::size_t>(k % m);
+        const std::size_t b = static_cast<std::size_t>((m - k) % m);
+        const double er = 0.5 * (m_re[a] + m_re[b]);
+        const double ei = 0.5 * (m_im[a] - m_im[b]);
+        const double orr = 0.5 * (m_im[a] + m_im[b]);
+        const double oi = -0.5 * (m_re[a] - m_re[b]);
+        const double wr = m_splitRe[static_cast<std::size_t>(k)];
+        const double wi = m_splitIm[static_cast<std::size_t>(k)];
+        const double xr = er + wr * orr - wi * oi;
+        const double xi = ei + wr * oi + wi * orr;
+        power[k] = xr * xr + xi * xi;
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef FFTKERNEL_H
+#define FFTKERNEL_H
+
+#include <vector>
+
+// 自带的实数 FFT，不依赖外部库：N 点实数序列两两打包成 N/2 点复数序列，
+// 做一次基 2 迭代 FFT（按时间抽取）后再拆分出实数序列的频谱。
+// 旋转因子按级连续存放，蝶形内层循环在编译器启用 AVX 时每次处理 4 个、SSE2 时 2 个。
+// 对象持有预计算表和工作缓冲，不可跨线程共用。
+class RealFft
+{
+public:
+    explicit RealFft(int size); // size 为 2 的幂，不小于 4
+
+    int size() const { return m_size; }
+    int bins() const { return m_size / 2 + 1; }
+
+    // in 为 size 个（已加窗的）样本，power 输出 bins() 个 |X[k]|²
+    void powerSpectrum(const double *in, double *power);
+
+private:
+    void transform(); // 对 m_re/m_im 做 m_half 点复数 FFT
+
+    int m_size = 0;
+    int m_half = 0;
+    std::vector<int> m_bitrev;
+    std::vector<double> m_twRe; // 半长为 h 的一级所用旋转因子位于 [h, 2h)
+    std::vector<double> m_twIm;
+    std::vector<double> m_splitRe; // 拆分用的 e^{-2πik/N}，k = 0..N/2
+    std::vector<double> m_splitIm;
+    std::vector<double> m_re;
+    std::vector<double> m_im;
+};
+
+#endif // FFTKERNEL_H
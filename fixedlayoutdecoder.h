@@ -0,0 +1,125 @@
+#ifndef FIXEDLAYOUTDECODER_H
+#define FIXEDLAYOUTDECODER_H
+
+#include <QStringList>
+#include <cstddef>
+#include <cstdint>
+#include <ratio>
+#include <utility>
+#include "packetdecoder.h"
+
+// 编译期定长帧解码器：帧布局写成 C++ 类型列表，字段偏移、字节序、缩放系数、
+// 越界检查和校验方式全部是模板参数，解码展开为直线式的定长读取，
+// 没有逐字段的解释开销。与 SchemaDecoder 实现同一个 PacketDecoder 接口。
+//
+// 用法：
+//   using Imu = FixedLayout::Decoder<FixedLayout::Sync<0xAA, 0x55>, 20,
+//                                    PacketCodec::Checksum::Sum8, 2,
+//                                    FixedLayout::Field<std::int16_t, 2, FixedLayout::Endian::Little, std::ratio<1, 1000>>,
+//                                    FixedLayout::Array<float, 4, 3>>;
+namespace FixedLayout {
+
+enum class Endian { Little, Big };
+
+template <std::uint8_t... Bytes>
+struct Sync {
+    static constexpr std::size_t kSize = sizeof...(Bytes);
+    static constexpr char kBytes[kSize > 0 ? kSize : 1] = {static_cast<char>(Bytes)...};
+};
+
+// 单个字段：值 = 原始值 * Scale + Bias
+template <typename T, std::size_t Offset, Endian E = Endian::Little,
+          typename Scale = std::ratio<1>, typename Bias = std::ratio<0>>
+struct Field {
+    static constexpr int kCount = 1;
+    static constexpr std::size_t kEnd = Offset + sizeof(T);
+
+    static inline void read(const char *frame, double *&out)
+    {
+        constexpr double scale = static_cast<double>(Scale::num) / Scale::den;
+        constexpr double bias = static_cast<double>(Bias::num) / Bias::den;
+        *out++ = static_cast<double>(PacketCodec::load<T>(frame + Offset, E == Endian::Big)) * scale + bias;
+    }
+};
+
+// 定长数组字段，展开为 Count 个通道
+template <typename T, std::size_t Offset, int Count, Endian E = Endian::Little,
+          typename Scale = std::ratio<1>, typename Bias = std::ratio<0>>
+struct Array {
+    static_assert(Count > 0, "array field needs at least one element");
+    static constexpr int kCount = Count;
+    static constexpr std::size_t kEnd = Offset + sizeof(T) * static_cast<std::size_t>(Count);
+
+    static inline void read(const char *frame, double *&out)
+    {
+        readElements(frame, out, std::make_index_sequence<static_cast<std::size_t>(Count)>());
+    }
+
+private:
+    template <std::size_t... I>
+    static inline void readElements(const char *frame, double *&out, std::index_sequence<I...>)
+    {
+        (Field<T, Offset + sizeof(T) * I, E, Scale, Bias>::read(frame, out), ...);
+    }
+};
+
+template <typename SyncT, std::size_t Size, PacketCodec::Checksum Cs, std::size_t CsStart, typename... Fields>
+class Decoder : public PacketDecoder
+{
+public:
+    static constexpr int kChannels = (Fields::kCount + ... + 0);
+    static constexpr std::size_t kChecksumSize = static_cast<std::size_t>(PacketCodec::checksumSize(Cs));
+
+    static_assert(sizeof...(Fields) > 0, "layout needs at least one field");
+    static_assert(Size >= SyncT::kSize + kChecksumSize, "frame too small for sync and checksum");
+    static_assert(CsStart + kChecksumSize <= Size, "checksum range outside frame");
+    static_assert(((Fields::kEnd <= Size - kChecksumSize) && ...), "field outside frame");
+
+    // names 依次对应展开后的每个通道
+    explicit Decoder(const QStringList &names)
+        : m_names(names)
+    {
+        while (m_names.size() < kChannels) m_names << QStringLiteral("ch%1").arg(m_names.size() + 1);
+        while (m_names.size() > kChannels) m_names.removeLast();
+    }
+
+    QStringList channelNames() const override { return m_names; }
+
+    std::size_t decode(const char *data, std::size_t size, FrameSink &sink) override
+    {
+        std::size_t pos = 0;
+        double values[kChannels];
+        while (pos + Size <= size) {
+            const std::size_t found = PacketCodec::findSync(data + pos, size - pos, SyncT::kBytes, SyncT::kSize);
+            if (found == size - pos) {
+                const std::size_t keep = SyncT::kSize > 0 ? SyncT::kSize - 1 : 0;
+                m_stats.skippedBytes += found - keep;
+                return size - keep;
+            }
+            m_stats.skippedBytes += found;
+            pos += found;
+            if (pos + Size > size) break;
+
+            const char *frame = data + pos;
+            const auto *bytes = reinterpret_cast<const unsigned char *>(frame);
+            if (!PacketCodec::verifyChecksum(Cs, bytes + CsStart, bytes + Size - kChecksumSize)) {
+                ++m_stats.checksumErrors;
+                ++pos;
+                continue;
+            }
+            double *out = values;
+            (Fields::read(frame, out), ...);
+            sink.frame(0, values, kChannels);
+            ++m_stats.frames;
+            pos += Size;
+        }
+        return pos;
+    }
+
+private:
+    QStringList m_names;
+};
+
+} // namespace FixedLayout
+
+#endif // FIXEDLAYOUTDECODER_H
@@ -0,0 +1,84 @@
+#include "framedecodeworker.h"
+
+#include <QDateTime>
+#include "attitudeworker.h"
+#include "channelregistry.h"
+
+FrameDecodeWorker::FrameDecodeWorker(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void FrameDecodeWorker::setSinks(ChannelRegistry *registry, AttitudeWorker *att)
+{
+    m_registry = registry;
+    m_attSink = att;
+}
+
+void FrameDecodeWorker::setDecoder(std::shared_ptr<PacketDecoder> decoder)
+{
+    std::atomic_store(&m_pending, std::move(decoder));
+}
+
+void FrameDecodeWorker::bindDecoder(const std::shared_ptr<PacketDecoder> &decoder)
+{
+    m_decoder = decoder;
+    m_carry.clear();
+    m_channelIds.clear();
+    m_rollChannel = m_pitchChannel = m_yawChannel = -1;
+    if (!m_decoder) return;
+
+    const QStringList names = m_decoder->channelNames();
+    for (int i = 0; i < names.size(); ++i) {
+        const QString &name = names.at(i);
+        m_channelIds.push_back(m_registry ? m_registry->ensureChannel(name) : -1);
+        const QString lower = name.toLower();
+        if (lower == QLatin1String("roll")) m_rollChannel = i;
+        else if (lower == QLatin1String("pitch")) m_pitchChannel = i;
+        else if (lower == QLatin1String("yaw")) m_yawChannel = i;
+    }
+}
+
+void FrameDecodeWorker::processPacket(const QByteArray &packet)
+{
+    const std::shared_ptr<PacketDecoder> current = std::atomic_load(&m_pending);
+    if (current != m_decoder) bindDecoder(current);
+    if (!m_decoder || packet.isEmpty()) return;
+
+    m_frameTimeMs = QDateTime::currentMSecsSinceEpoch();
+    m_attTouched = false;
+    const quint64 framesBefore = m_decoder->stats().frames;
+
+    // 无残留时直接在数据包上解码，只把末尾半帧复制进 m_carry
+    std::size_t consumed = 0;
+    if (m_carry.isEmpty()) {
+        consumed = m_decoder->decode(packet.constData(), static_cast<std::size_t>(packet.size()), *this);
+        m_carry = packet.mid(static_cast<qsizetype>(consumed));
+    } else {
+        m_carry.append(packet);
+        consumed = m_decoder->decode(m_carry.constData(), static_cast<std::size_t>(m_carry.size()), *this);
+        m_carry.remove(0, static_cast<qsizetype>(consumed));
+    }
+    if (m_carry.size() > kMaxCarry) {
+        m_carry.clear(); // 长时间无法成帧，丢弃以免无限增长
+    }
+
+    if (m_decoder->stats().frames == framesBefore) return;
+    // 姿态只取本批最后一帧的值
+    if (m_attSink && m_attTouched) {
+        m_attSink->appendAttitude(m_att[0], m_att[1], m_att[2]);
+    }
+    if (m_registry) m_registry->notifyAppended();
+}
+
+void FrameDecodeWorker::frame(int firstChannel, const double *values, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const int ch = firstChannel + i;
+        if (m_registry) m_registry->append(m_channelIds[static_cast<std::size_t>(ch)], m_frameTimeMs, values[i]);
+        if (ch == m_rollChannel || ch == m_pitchChannel || ch == m_yawChannel) {
+            m_att[ch == m_rollChannel ? 0 : (ch == m_pitchChannel ? 1 : 2)] = values[i];
+            m_attTouched = true;
+        }
+    }
+}
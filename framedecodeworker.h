@@ -0,0 +1,50 @@
+#ifndef FRAMEDECODEWORKER_H
+#define FRAMEDECODEWORKER_H
+
+#include <QByteArray>
+#include <QObject>
+#include <memory>
+#include <vector>
+#include "packetdecoder.h"
+
+class AttitudeWorker;
+class ChannelRegistry;
+
+// 二进制帧解码阶段：接收 SerialPortWorker 的原始数据包，拼接跨包的半帧，
+// 交给当前解码器分帧解码，结果直接写入通道注册表。
+// 名为 roll/pitch/yaw 的通道同时送给 3D 姿态。
+class FrameDecodeWorker : public QObject, private FrameSink
+{
+    Q_OBJECT
+public:
+    explicit FrameDecodeWorker(QObject *parent = nullptr);
+
+    // 以下接口可在任意线程直接调用；解码器交出后只在本线程使用
+    void setSinks(ChannelRegistry *registry, AttitudeWorker *att);
+    void setDecoder(std::shared_ptr<PacketDecoder> decoder);
+
+public slots:
+    void processPacket(const QByteArray &packet);
+
+private:
+    void frame(int firstChannel, const double *values, int count) override;
+    void bindDecoder(const std::shared_ptr<PacketDecoder> &decoder);
+
+    static constexpr int kMaxCarry = 64 * 1024;
+
+    std::shared_ptr<PacketDecoder> m_pending; // 只通过 std::atomic_load/atomic_store 访问
+    std::shared_ptr<PacketDecoder> m_decoder;
+    ChannelRegistry* m_registry = nullptr;
+    AttitudeWorker* m_attSink = nullptr;
+
+    QByteArray m_carry;
+    qint64 m_frameTimeMs = 0;
+    std::vector<int> m_channelIds; // 解码器通道序号 -> 注册表序号
+    int m_rollChannel = -1;
+    int m_pitchChannel = -1;
+    int m_yawChannel = -1;
+    double m_att[3] = {0.0, 0.0, 0.0};
+    bool m_attTouched = false;
+};
+
+#endif // FRAMEDECODEWORKER_H
@@ -0,0 +1,134 @@
+#include "highlightrules.h"
+
+#include <QTextCharFormat>
+#include <algorithm>
+#include <limits>
+
+bool HighlightRuleSet::needsOwnMatch(const QString &pattern, const QRegularExpression &single)
+{
+    // 命名分组在组合正则里可能重名
+    for (const QString &name : single.namedCaptureGroups()) {
+        if (!name.isEmpty()) return true;
+    }
+    // 按编号或名字引用分组的写法：\1 \g \k (?P= (?P> (?& (?R (?1 (?+1 (?-1 (?|
+    for (qsizetype i = 0; i < pattern.size(); ++i) {
+        const QChar c = pattern.at(i);
+        if (c == QLatin1Char('\\') && i + 1 < pattern.size()) {
+            const QChar n = pattern.at(++i);
+            if ((n >= QLatin1Char('1') && n <= QLatin1Char('9')) || n == QLatin1Char('g') || n == QLatin1Char('k')) return true;
+        } else if (c == QLatin1Char('(') && i + 2 < pattern.size() && pattern.at(i + 1) == QLatin1Char('?')) {
+            const QChar n = pattern.at(i + 2);
+            if (n == QLatin1Char('&') || n == QLatin1Char('R') || n == QLatin1Char('|') || n == QLatin1Char('+')
+                || n == QLatin1Char('-') || n.isDigit()) {
+                // (?- 后跟字母是关闭选项，不是相对引用
+                if (n != QLatin1Char('-') || (i + 3 < pattern.size() && pattern.at(i + 3).isDigit())) return true;
+            }
+            if (n == QLatin1Char('P') && i + 3 < pattern.size()
+                && (pattern.at(i + 3) == QLatin1Char('=') || pattern.at(i + 3) == QLatin1Char('>'))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void HighlightRuleSet::compile(const QStringList &specs)
+{
+    m_rules.clear();
+    QStringList alternatives;
+    for (const QString &rawSpec : specs) {
+        const QString spec = rawSpec.trimmed();
+        const int sp = spec.indexOf(QLatin1Char(' '));
+        if (sp <= 0) continue;
+        QStringList head = spec.left(sp).split(QLatin1Char(','), Qt::SkipEmptyParts);
+        const QString pattern = spec.mid(sp + 1).trimmed();
+        if (head.isEmpty() || pattern.isEmpty()) continue;
+
+        const QColor color(head.takeFirst());
+        if (!color.isValid()) continue;
+        const QRegularExpression single(pattern);
+        if (!single.isValid()) continue;
+
+        Rule rule;
+        rule.color = color.rgb();
+        rule.wholeLine = head.contains(QStringLiteral("line"), Qt::CaseInsensitive);
+        rule.hasField = single.captureCount() > 0;
+        rule.re = single;
+        rule.re.optimize();
+        if (!needsOwnMatch(pattern, single)) {
+            rule.prefiltered = true;
+            alternatives << QStringLiteral("(?:") + pattern + QLatin1Char(')');
+        }
+        m_rules.append(rule);
+    }
+    m_combined = QRegularExpression();
+    if (alternatives.isEmpty()) return;
+
+    QRegularExpression combined(alternatives.join(QLatin1Char('|')));
+    if (!combined.isValid()) {
+        // 上面没识别出的冲突：不预筛，每行所有规则都匹配，而不是丢掉所有着色
+        for (Rule &rule : m_rules) rule.prefiltered = false;
+        return;
+    }
+    m_combined = combined;
+    m_combined.optimize();
+}
+
+void HighlightRuleSet::appendRuns(QVector<StyleRun> &runs, const Rule &rule, const QRegularExpressionMatch &m,
+                                  qsizetype lineLength) const
+{
+    constexpr qsizetype kMaxOffset = std::numeric_limits<quint16>::max();
+    qsizetype start = m.capturedStart(0);
+    qsizetype len = m.capturedLength(0);
+    if (rule.wholeLine) {
+        start = 0;
+        len = lineLength;
+    } else if (rule.hasField && m.capturedStart(1) >= 0) {
+        start = m.capturedStart(1);
+        len = m.capturedLength(1);
+    }
+    if (start < kMaxOffset && len > 0) {
+        len = std::min(len, kMaxOffset - start);
+        runs.append(StyleRun{static_cast<quint16>(start), static_cast<quint16>(len), rule.color});
+    }
+}
+
+QVector<StyleRun> HighlightRuleSet::evaluate(const QString &line) const
+{
+    QVector<StyleRun> runs;
+    if (m_rules.isEmpty() || line.isEmpty()) return runs;
+
+    // 组合正则没有命中说明参与预筛的规则都不会命中，只剩不参与预筛的规则要匹配
+    const bool anyPrefiltered = m_combined.pattern().isEmpty() || m_combined.match(line).hasMatch();
+    for (const Rule &rule : m_rules) {
+        if (rule.prefiltered && !anyPrefiltered) continue;
+        QRegularExpressionMatchIterator it = rule.re.globalMatch(line);
+        while (it.hasNext()) {
+            appendRuns(runs, rule, it.next(), line.size());
+            if (rule.wholeLine) break;
+        }
+    }
+    // 宽的区间先画，字段着色可以覆盖在整行着色之上
+    std::stable_sort(runs.begin(), runs.end(), [](const StyleRun &a, const StyleRun &b) {
+        return a.length > b.length;
+    });
+    return runs;
+}
+
+RecvHighlighter::RecvHighlighter(QTextDocument *parent)
+    : QSyntaxHighlighter(parent)
+{
+}
+
+void RecvHighlighter::highlightBlock(const QString &text)
+{
+    const auto *data = static_cast<const StyleRunData*>(currentBlockUserData());
+    if (!data) return;
+    for (const StyleRun &run : data->runs) {
+        const int start = data->offset + run.start;
+        if (start >= text.size()) continue;
+        QTextCharFormat fmt;
+        fmt.setForeground(QColor::fromRgb(run.color));
+        setFormat(start, std::min<int>(run.length, static_cast<int>(text.size()) - start), fmt);
+    }
+}
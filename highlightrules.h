@@ -0,0 +1,68 @@
+#ifndef HIGHLIGHTRULES_H
+#define HIGHLIGHTRULES_H
+
+#include <QColor>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QSyntaxHighlighter>
+#include <QTextBlockUserData>
+#include <QVector>
+
+// 紧凑的着色区间：行内偏移 + 长度 + 前景色
+struct StyleRun {
+    quint16 start = 0;
+    quint16 length = 0;
+    QRgb color = 0;
+};
+
+// 用户着色规则，每行一条：  <颜色>[,line] <正则>
+//   red,line ERROR         整行标红
+//   #f9a825 WARN           只给匹配到的关键字着色
+//   cyan temp=(\d+)        有捕获组时只给第一个捕获组着色
+// 所有规则另外编译成一个交替正则作为预筛：一行中没有任何规则命中时只扫描这一遍。
+// 有命中时每条规则用自己的正则各匹配一遍，互相重叠的规则（如整行规则里的字段规则）都能着色。
+// 含反向引用、子程序调用或命名分组的规则放进组合正则后编号/名字会错位，不参与预筛、始终匹配。
+class HighlightRuleSet
+{
+public:
+    void compile(const QStringList &specs);
+    bool isEmpty() const { return m_rules.isEmpty(); }
+    QVector<StyleRun> evaluate(const QString &line) const;
+
+private:
+    struct Rule {
+        QRgb color = 0;
+        bool wholeLine = false;
+        bool prefiltered = false; // 已放进组合正则，组合正则无命中时可以跳过
+        bool hasField = false; // 规则自带捕获组，着色第一个捕获组
+        QRegularExpression re;
+    };
+
+    static bool needsOwnMatch(const QString &pattern, const QRegularExpression &single);
+    void appendRuns(QVector<StyleRun> &runs, const Rule &rule, const QRegularExpressionMatch &m,
+                    qsizetype lineLength) const;
+
+    QRegularExpression m_combined; // 预筛用的交替正则，为空时不预筛
+    QVector<Rule> m_rules;
+};
+
+// 着色结果挂在文本块上，排版绘制时由 RecvHighlighter 读取
+class StyleRunData : public QTextBlockUserData
+{
+public:
+    StyleRunData(int offset, const QVector<StyleRun> &runs) : offset(offset), runs(runs) {}
+    int offset = 0;  // 行首时间戳等前缀长度
+    QVector<StyleRun> runs;
+};
+
+class RecvHighlighter : public QSyntaxHighlighter
+{
+    Q_OBJECT
+public:
+    explicit RecvHighlighter(QTextDocument *parent);
+
+protected:
+    void highlightBlock(const QString &text) override;
+};
+
+#endif // HIGHLIGHTRULES_H
@@ -0,0 +1,82 @@
+#include "linecollapser.h"
+
+void LineCollapser::setEnabled(bool on)
+{
+    m_enabled = on;
+    reset();
+}
+
+void LineCollapser::setIgnoreDigits(bool on)
+{
+    m_ignoreDigits = on;
+    reset();
+}
+
+void LineCollapser::reset()
+{
+    m_hasRun = false;
+    m_line.clear();
+    m_count = 0;
+}
+
+quint64 LineCollapser::hashLine(const QString &line) const
+{
+    // FNV-1a，逐字符滚动；忽略数字时整段数字折算为一个占位符
+    quint64 h = 1469598103934665603ULL;
+    bool inDigits = false;
+    for (const QChar c : line) {
+        ushort u = c.unicode();
+        if (m_ignoreDigits && u >= '0' && u <= '9') {
+            if (inDigits) continue;
+            inDigits = true;
+            u = '#';
+        } else {
+            inDigits = false;
+        }
+        h ^= u;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+bool LineCollapser::sameAsPrevious(const QString &line) const
+{
+    if (!m_ignoreDigits) return line == m_line;
+    // 忽略数字时按与 hashLine 相同的规则比较：整段数字视为同一个占位符
+    const QChar *a = line.constData();
+    const QChar *aEnd = a + line.size();
+    const QChar *b = m_line.constData();
+    const QChar *bEnd = b + m_line.size();
+    auto isDigit = [](QChar c) { return c.unicode() >= '0' && c.unicode() <= '9'; };
+    while (a != aEnd && b != bEnd) {
+        if (isDigit(*a) && isDigit(*b)) {
+            while (a != aEnd && isDigit(*a)) ++a;
+            while (b != bEnd && isDigit(*b)) ++b;
+            continue;
+        }
+        if (*a != *b) return false;
+        ++a;
+        ++b;
+    }
+    return a == aEnd && b == bEnd;
+}
+
+bool LineCollapser::feed(const QString &line, qint64 timestampMs)
+{
+    if (!m_enabled) return false;
+    const quint64 h = hashLine(line);
+    // 64 位 FNV 并不抗碰撞，哈希相同后再逐字符比较，哈希只用来快速排除不同的行
+    const bool same = m_hasRun && h == m_hash && sameAsPrevious(line);
+    if (same) {
+        ++m_count;
+        m_lastMs = timestampMs;
+        return true;
+    }
+    m_hasRun = true;
+    m_hash = h;
+    m_line = line;
+    m_count = 1;
+    m_firstMs = timestampMs;
+    m_lastMs = timestampMs;
+    return false;
+}
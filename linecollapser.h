@@ -0,0 +1,38 @@
+#ifndef LINECOLLAPSER_H
+#define LINECOLLAPSER_H
+
+#include <QString>
+#include <QtGlobal>
+
+// 连续重复行折叠：对每行计算 64 位滚动哈希（可忽略数字，从而忽略计数器/时间戳差异），
+// 与上一行哈希相同且逐字符比较确认相同后只累加计数，不再把重复行送往渲染。
+class LineCollapser
+{
+public:
+    void setEnabled(bool on);
+    void setIgnoreDigits(bool on);
+    bool isEnabled() const { return m_enabled; }
+    void reset();
+
+    // 返回 true 表示该行延续了当前的重复段
+    bool feed(const QString &line, qint64 timestampMs);
+
+    int count() const { return m_count; }
+    qint64 firstMs() const { return m_firstMs; }
+    qint64 lastMs() const { return m_lastMs; }
+
+private:
+    quint64 hashLine(const QString &line) const;
+    bool sameAsPrevious(const QString &line) const; // 哈希相同后的逐字符确认，排除碰撞
+
+    bool m_enabled = false;
+    bool m_ignoreDigits = false;
+    bool m_hasRun = false;
+    quint64 m_hash = 0;
+    QString m_line; // 当前重复段的首行（隐式共享，不复制数据）
+    int m_count = 0;
+    qint64 m_firstMs = 0;
+    qint64 m_lastMs = 0;
+};
+
+#endif // LINECOLLAPSER_H
@@ -0,0 +1,194 @@
+#include "logwriter.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
+#include <QtEndian>
+
+LogWriter::LogWriter(QObject *parent)
+    : QObject(parent)
+{
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setInterval(kFlushIntervalMs);
+    connect(m_flushTimer, &QTimer::timeout, this, &LogWriter::flushPending);
+}
+
+LogWriter::~LogWriter()
+{
+    closeSession();
+}
+
+void LogWriter::openSession()
+{
+    if (!m_sessionDir.isEmpty()) return;
+
+    QString base = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    if (base.isEmpty()) base = QDir::tempPath() + QLatin1String("/HiCOM");
+    m_sessionDir = base + QLatin1String("/logs/session_")
+                   + QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd_hhmmss_zzz"));
+    QDir().mkpath(m_sessionDir);
+    m_segments.clear();
+    m_segmentIndex = 0;
+    m_pending.clear();
+    m_flushTimer->start();
+}
+
+void LogWriter::closeSession()
+{
+    if (m_sessionDir.isEmpty()) return;
+    m_flushTimer->stop();
+    closeSegment();
+    // 会话分段只是保存前的暂存区，退出或清空时删除
+    QDir(m_sessionDir).removeRecursively();
+    m_sessionDir.clear();
+    m_segments.clear();
+}
+
+void LogWriter::resetSession()
+{
+    closeSession();
+    openSession();
+}
+
+void LogWriter::appendText(const QString &text)
+{
+    if (text.isEmpty() || m_sessionDir.isEmpty()) return;
+    m_pending.append(text.toUtf8());
+    if (m_pending.size() >= kFlushBytes) {
+        flushPending();
+    }
+}
+
+void LogWriter::setRotation(qint64 maxSegmentBytes, int maxSegmentSeconds)
+{
+    m_maxSegmentBytes = maxSegmentBytes;
+    m_maxSegmentSeconds = maxSegmentSeconds;
+}
+
+void LogWriter::setCompression(bool enabled)
+{
+    if (m_compress == enabled) return;
+    m_compress = enabled;
+    // 压缩方式按分段固定，切换后从下一段开始生效
+    flushPending();
+    closeSegment();
+}
+
+void LogWriter::flushPending()
+{
+    if (m_pending.isEmpty()) return;
+    if (m_file.isOpen() && needsRotation()) {
+        closeSegment();
+    }
+    if (!m_file.isOpen() && !openNextSegment()) {
+        m_pending.clear();
+        return;
+    }
+    writeBlock(m_pending);
+    m_pending.clear();
+}
+
+bool LogWriter::needsRotation() const
+{
+    if (m_maxSegmentBytes > 0 && m_segmentBytes >= m_maxSegmentBytes) return true;
+    if (m_maxSegmentSeconds > 0
+        && QDateTime::currentMSecsSinceEpoch() - m_segmentOpenedMs >= qint64(m_maxSegmentSeconds) * 1000) {
+        return true;
+    }
+    return false;
+}
+
+bool LogWriter::openNextSegment()
+{
+    if (m_sessionDir.isEmpty()) return false;
+    const QString path = QStringLiteral("%1/seg_%2.%3")
+                             .arg(m_sessionDir)
+                             .arg(m_segmentIndex++, 5, 10, QLatin1Char('0'))
+                             .arg(m_compress ? QStringLiteral("logz") : QStringLiteral("log"));
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        return false;
+    }
+    m_segments << path;
+    m_segmentBytes = 0;
+    m_segmentOpenedMs = QDateTime::currentMSecsSinceEpoch();
+    m_segmentCompressed = m_compress;
+    return true;
+}
+
+void LogWriter::closeSegment()
+{
+    if (m_file.isOpen()) {
+        m_file.flush();
+        m_file.close();
+    }
+}
+
+bool LogWriter::writeBlock(const QByteArray &raw)
+{
+    if (!m_segmentCompressed) {
+        const qint64 n = m_file.write(raw);
+        if (n > 0) m_segmentBytes += n;
+        return n == raw.size();
+    }
+
+    // 压缩块格式：4 字节大端块长度 + qCompress 输出（自带原始长度）
+    const QByteArray packed = qCompress(raw, kCompressLevel);
+    uchar header[4];
+    qToBigEndian<quint32>(static_cast<quint32>(packed.size()), header);
+    if (m_file.write(reinterpret_cast<const char*>(header), 4) != 4) return false;
+    const qint64 n = m_file.write(packed);
+    if (n > 0) m_segmentBytes += n + 4;
+    return n == packed.size();
+}
+
+bool LogWriter::copySegment(const QString &segPath, QFile &out) const
+{
+    QFile in(segPath);
+    if (!in.open(QIODevice::ReadOnly)) return false;
+
+    if (!segPath.endsWith(QLatin1String(".logz"))) {
+        while (!in.atEnd()) {
+            const QByteArray chunk = in.read(1024 * 1024);
+            if (chunk.isEmpty() || out.write(chunk) != chunk.size()) return false;
+        }
+        return true;
+    }
+
+    while (!in.atEnd()) {
+        uchar header[4];
+        if (in.read(reinterpret_cast<char*>(header), 4) != 4) return false;
+        const quint32 len = qFromBigEndian<quint32>(header);
+        const QByteArray packed = in.read(len);
+        if (packed.size() != static_cast<int>(len)) return false;
+        const QByteArray raw = qUncompress(packed);
+        if (out.write(raw) != raw.size()) return false;
+    }
+    return true;
+}
+
+void LogWriter::exportTo(const QString &path, const QString &sendText)
+{
+    flushPending();
+    if (m_file.isOpen()) m_file.flush();
+
+    QFile out(path);
+    if (!out.open(QIODevice::WriteOnly)) {
+        emit exportFinished(path, false, out.errorString());
+        return;
+    }
+
+    bool ok = out.write("===== Receive =====\n") > 0;
+    for (const QString &seg : m_segments) {
+        if (!ok) break;
+        ok = copySegment(seg, out);
+    }
+    if (ok) {
+        ok = out.write("\n===== Send =====\n") > 0;
+        const QByteArray send = sendText.toUtf8();
+        ok = ok && out.write(send) == send.size() && out.write("\n") == 1;
+    }
+    const QString err = ok ? QString() : out.errorString();
+    out.close();
+    emit exportFinished(path, ok, err);
+}
@@ -0,0 +1,61 @@
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+// 后台日志落盘：接收到的文本按行追加到会话目录下的分段文件中，
+// 大块缓冲写入，按大小/时长滚动分段，可选 qCompress 块压缩。
+// “保存记录”只需把已写好的分段拼接复制到目标文件。
+class LogWriter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogWriter(QObject *parent = nullptr);
+    ~LogWriter() override;
+
+public slots:
+    void openSession();
+    void closeSession();
+    void resetSession();
+    void appendText(const QString &text);
+    void setRotation(qint64 maxSegmentBytes, int maxSegmentSeconds);
+    void setCompression(bool enabled);
+    void exportTo(const QString &path, const QString &sendText);
+
+signals:
+    void exportFinished(QString path, bool ok, QString error);
+
+private slots:
+    void flushPending();
+
+private:
+    bool openNextSegment();
+    void closeSegment();
+    bool writeBlock(const QByteArray &raw);
+    bool needsRotation() const;
+    bool copySegment(const QString &segPath, QFile &out) const;
+
+    static constexpr int kFlushBytes = 256 * 1024;
+    static constexpr int kFlushIntervalMs = 1000;
+    static constexpr int kCompressLevel = 6;
+
+    QString m_sessionDir;
+    QStringList m_segments;
+    QFile m_file;
+    QByteArray m_pending;
+    qint64 m_segmentBytes = 0;
+    qint64 m_segmentOpenedMs = 0;
+    qint64 m_maxSegmentBytes = 64LL * 1024 * 1024;
+    int m_maxSegmentSeconds = 3600;
+    bool m_compress = false;
+    bool m_segmentCompressed = false;
+    int m_segmentIndex = 0;
+    QTimer* m_flushTimer = nullptr;
+};
+
+#endif // LOGWRITER_H
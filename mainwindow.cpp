@@ -1,5 +1,7 @@
 ﻿#include "mainwindow.h"
 #include "./ui_mainwindow.h"
+#include "binaryschema.h"
+#include "builtindecoders.h"
 
 #include <QCheckBox>
 #include <QComboBox>
@@ -20,13 +22,12 @@
 #include <QSignalBlocker>
 #include <QSpinBox>
 #include <QStatusBar>
+#include <QTextBlock>
 #include <QTextEdit>
 #include <QTextStream>
 #include <QStringDecoder>
 #include <QTimer>
 #include <QVBoxLayout>
-#include <QToolTip>
-#include <limits>
 #include <QStackedLayout>
 #include <Qt3DCore/QEntity>
 #include <Qt3DExtras/Qt3DWindow>
@@ -47,10 +48,6 @@
 #endif
 
 namespace {
-QString formatAsHex(const QByteArray &data) {
-    return data.toHex(' ').toUpper();
-}
-
 QByteArray parseHexString(const QString &text, bool *ok) {
     QByteArray result;
     QString cleaned = text;
@@ -90,6 +87,7 @@ MainWindow::MainWindow(QWidget *parent)
     m_statusRx = new QLabel(this);
     m_statusTx = new QLabel(this);
     m_statusMatch = new QLabel(this);
+    m_statusRender = new QLabel(this);
     m_statusMatch->setTextFormat(Qt::PlainText);
     m_statusMatch->setMinimumWidth(200);
     m_statusMatch->setAlignment(Qt::AlignCenter);
@@ -115,10 +113,12 @@ MainWindow::MainWindow(QWidget *parent)
         m_recvSearchPanel->setVisible(false);
     }
     m_enableDebug = (ENABLE_DEBUG_LOG != 0);
+    m_recvHighlighter = new RecvHighlighter(ui->recvEdit->document());
     resetDecoderFromUi();
     updateStatusLabels();
     ui->statusbar->addWidget(m_statusConn);
     ui->statusbar->addWidget(m_statusMatch, 1);
+    ui->statusbar->addPermanentWidget(m_statusRender);
     ui->statusbar->addPermanentWidget(m_statusRx);
     ui->statusbar->addPermanentWidget(m_statusTx);
     m_recvFontPt = ui->recvEdit->font().pointSize();
@@ -148,8 +148,11 @@ MainWindow::MainWindow(QWidget *parent)
         updateStatusLabels();
         resetDecoderFromUi();
         m_hasAttData = false;
-        m_recvLineBuffer.clear();
-        m_lastRecvFlushMs = 0;
+        m_recvRunRepeat = 0;
+        m_recvRunLogged = 0;
+        if (m_logWriter) {
+            QMetaObject::invokeMethod(m_logWriter, "resetSession", Qt::QueuedConnection);
+        }
     });
     // 搜索栏与快捷键
     QShortcut* findShortcut = new QShortcut(QKeySequence::Find, ui->recvEdit);
@@ -236,9 +239,17 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->chk_rev_ansi, &QCheckBox::toggled, this, [this](bool on) {
         m_enableAnsiColors = on;
     });
+    // 自动识别：按块判断文本/二进制与 UTF-8/GB18030，二进制块按 HEX 显示
+    ui->comboEncoding->addItem(QString::fromUtf8(u8"自动识别"));
     connect(ui->comboEncoding, qOverload<int>(&QComboBox::currentIndexChanged), this, [this](int){
         resetDecoderFromUi();
     });
+    connect(ui->chk_rev_hex, &QCheckBox::toggled, this, [this](bool on) {
+        QMetaObject::invokeMethod(m_decodeWorker, "setHexMode", Qt::QueuedConnection, Q_ARG(bool, on));
+    });
+    connect(ui->chk_rev_line, &QCheckBox::toggled, this, [this](bool on) {
+        QMetaObject::invokeMethod(m_decodeWorker, "setLineMode", Qt::QueuedConnection, Q_ARG(bool, on));
+    });
     connect(ui->txtSendMs, qOverload<int>(&QSpinBox::valueChanged), this, [this](int v) {
         if (m_autoSend) {
             m_sendTimer->setInterval(v);
@@ -251,8 +262,21 @@ MainWindow::MainWindow(QWidget *parent)
     connect(m_serialThread, &QThread::finished, m_serialWorker, &QObject::deleteLater);
     m_serialThread->start();
 
+    // 解码与分行在独立线程完成，GUI 只接收整理好的行记录
+    qRegisterMetaType<DecodedBatch>("DecodedBatch");
+    m_decodeThread = new QThread(this);
+    m_decodeWorker = new DecodeWorker;
+    m_decodeWorker->moveToThread(m_decodeThread);
+    connect(m_decodeThread, &QThread::finished, m_decodeWorker, &QObject::deleteLater);
+    m_decodeWorker->setHexMode(ui->chk_rev_hex->isChecked());
+    m_decodeWorker->setLineMode(ui->chk_rev_line->isChecked());
+    m_decodeThread->start();
+    resetDecoderFromUi();
+
     connect(m_serialWorker, &SerialPortWorker::packetReady,
-            this, &MainWindow::onPacketReceived, Qt::QueuedConnection);
+            m_decodeWorker, &DecodeWorker::processPacket, Qt::QueuedConnection);
+    connect(m_decodeWorker, &DecodeWorker::batchReady,
+            this, &MainWindow::onDecodedBatch, Qt::QueuedConnection);
     connect(m_serialWorker, &SerialPortWorker::errorOccurred,
             this, &MainWindow::onErrorOccurred, Qt::QueuedConnection);
     connect(m_serialWorker, &SerialPortWorker::fatalError,
@@ -272,15 +296,49 @@ MainWindow::MainWindow(QWidget *parent)
             this, &MainWindow::updateAttitude, Qt::QueuedConnection);
     m_attThread->start();
 
-    // waveform worker/thread
-    m_waveThread = new QThread(this);
-    m_waveWorker = new WaveformWorker;
-    m_waveWorker->moveToThread(m_waveThread);
-    connect(m_waveWorker, &WaveformWorker::dataReady, this, &MainWindow::updateWaveform, Qt::QueuedConnection);
-    m_waveThread->start();
+    // 提取阶段：消费解码批次，直接写入波形/姿态缓冲和通道注册表
+    m_channels = new ChannelRegistry(this);
+    m_extractThread = new QThread(this);
+    m_extractWorker = new ExtractWorker;
+    m_extractWorker->setSinks(m_attWorker);
+    m_extractWorker->setChannelRegistry(m_channels);
+    m_extractWorker->moveToThread(m_extractThread);
+    connect(m_extractThread, &QThread::finished, m_extractWorker, &QObject::deleteLater);
+    connect(m_decodeWorker, &DecodeWorker::batchReady,
+            m_extractWorker, &ExtractWorker::processBatch, Qt::QueuedConnection);
+    connect(m_extractWorker, &ExtractWorker::customMatches,
+            this, &MainWindow::updateCustomMatchDisplay, Qt::QueuedConnection);
+    m_extractThread->start();
+
+    // 二进制协议解码：与文本解码并行消费同一份原始数据，未配置协议时直接返回
+    m_frameThread = new QThread(this);
+    m_frameWorker = new FrameDecodeWorker;
+    m_frameWorker->setSinks(m_channels, m_attWorker);
+    m_frameWorker->moveToThread(m_frameThread);
+    connect(m_frameThread, &QThread::finished, m_frameWorker, &QObject::deleteLater);
+    connect(m_serialWorker, &SerialPortWorker::packetReady,
+            m_frameWorker, &FrameDecodeWorker::processPacket, Qt::QueuedConnection);
+    m_frameThread->start();
+
+    // 后台日志落盘线程
+    m_logThread = new QThread(this);
+    m_logWriter = new LogWriter;
+    m_logWriter->moveToThread(m_logThread);
+    connect(m_logThread, &QThread::finished, m_logWriter, &QObject::deleteLater);
+    connect(m_logWriter, &LogWriter::exportFinished, this, &MainWindow::onLogExportFinished, Qt::QueuedConnection);
+    m_logThread->start();
+    QMetaObject::invokeMethod(m_logWriter, "openSession", Qt::QueuedConnection);
+    applyLogSettings();
 
     // setup UI extras
     setupWaveformTab();
+    setupSpectrumTab();
+    setupWatchTab();
+
+    m_statusRefreshTimer = new QTimer(this);
+    m_statusRefreshTimer->setInterval(WatchPanel::kRefreshMs);
+    connect(m_statusRefreshTimer, &QTimer::timeout, this, &MainWindow::refreshStatusBar);
+    m_statusRefreshTimer->start();
 
     QTimer::singleShot(0, this, [this]() {
         QMetaObject::invokeMethod(m_serialWorker, "initializeSerialPort", Qt::QueuedConnection);
@@ -320,6 +378,7 @@ MainWindow::MainWindow(QWidget *parent)
     m_waveRegexList = {QString::fromUtf8(u8"(-?\\d+(?:\\.\\d+)?)")};
     m_attRegex = QString::fromUtf8(u8"Roll:\\s*([-+]?\\d+(?:\\.\\d+)?)\\s+Pitch:\\s*([-+]?\\d+(?:\\.\\d+)?)\\s+Yaw:\\s*([-+]?\\d+(?:\\.\\d+)?)");
     m_customRegexEnableSpec = QStringLiteral("0");
+    rebuildExtractRules();
 
     // 右上角格式按钮，打开设置弹窗
     m_formatBtn = new QToolButton(this);
@@ -370,14 +429,32 @@ MainWindow::~MainWindow()
         m_serialThread->quit();
         m_serialThread->wait();
     }
+    if (m_decodeThread) {
+        m_decodeThread->quit();
+        m_decodeThread->wait();
+    }
+    if (m_extractThread) {
+        m_extractThread->quit();
+        m_extractThread->wait();
+    }
+    if (m_frameThread) {
+        m_frameThread->quit();
+        m_frameThread->wait();
+    }
+    if (m_spectrumThread) {
+        m_spectrumThread->quit();
+        m_spectrumThread->wait();
+    }
     if (m_attThread) {
         m_attThread->quit();
         m_attThread->wait();
         delete m_attWorker;
     }
-    if (m_waveThread) {
-        m_waveThread->quit();
-        m_waveThread->wait();
+    if (m_logThread) {
+        flushRepeatSummary(true); // 排在 closeSession 之前
+        QMetaObject::invokeMethod(m_logWriter, "closeSession", Qt::BlockingQueuedConnection);
+        m_logThread->quit();
+        m_logThread->wait();
     }
     delete ui;
 }
@@ -485,16 +562,10 @@ void MainWindow::resetDecoderFromUi()
         name = ui->comboEncoding->currentText();
     }
     m_decoderName = name;
-    if (name.compare(QStringLiteral("UTF-8"), Qt::CaseInsensitive) == 0) {
-        m_textDecoder = QStringDecoder(QStringConverter::Utf8);
-    } else if (name.compare(QStringLiteral("GBK"), Qt::CaseInsensitive) == 0
-               || name.compare(QStringLiteral("GB18030"), Qt::CaseInsensitive) == 0) {
-        m_textDecoder = QStringDecoder("GB18030");
-    } else if (name.compare(QStringLiteral("本地编码")) == 0
-               || name.compare(QStringLiteral("Local")) == 0) {
-        m_textDecoder = QStringDecoder(QStringConverter::System);
-    } else {
-        m_textDecoder = QStringDecoder(QStringConverter::Utf8);
+    if (!m_decodeWorker) return;
+    QMetaObject::invokeMethod(m_decodeWorker, "reset", Qt::QueuedConnection, Q_ARG(QString, name));
+    if (m_extractWorker) {
+        QMetaObject::invokeMethod(m_extractWorker, "reset", Qt::QueuedConnection);
     }
 }
 
@@ -562,28 +633,8 @@ void MainWindow::applyTheme(bool dark)
     qApp->setStyleSheet(style);
 
     // 波形区主题同步
-    if (m_wavePlot) {
-        const QColor bg = dark ? QColor(24, 24, 24) : QColor(255, 255, 255);
-        const QColor axis = dark ? QColor(230, 230, 230) : QColor(30, 30, 30);
-        const QColor grid = dark ? QColor(80, 80, 80) : QColor(180, 180, 180);
-        m_wavePlot->setBackground(bg);
-        if (auto rect = m_wavePlot->axisRect()) rect->setBackground(bg);
-        auto applyAxis = [&](QCPAxis* ax) {
-            if (!ax) return;
-            ax->setBasePen(QPen(axis));
-            ax->setTickPen(QPen(axis));
-            ax->setSubTickPen(QPen(axis));
-            ax->setLabelColor(axis);
-            ax->setTickLabelColor(axis);
-            if (ax->grid()) {
-                ax->grid()->setPen(QPen(grid));
-                ax->grid()->setSubGridPen(QPen(grid.lighter()));
-            }
-        };
-        applyAxis(m_wavePlot->xAxis);
-        applyAxis(m_wavePlot->yAxis);
-        m_wavePlot->replot(QCustomPlot::rpQueuedReplot);
-    }
+    if (m_waveView) m_waveView->applyTheme(dark);
+    if (m_spectrumView) m_spectrumView->applyTheme(dark);
 
     // 3D 区域背景与姿态标签
     if (m_3dWindow) {
@@ -611,77 +662,68 @@ void MainWindow::applyTheme(bool dark)
     }
 }
 
-void MainWindow::onPacketReceived(const QByteArray &packet)
+void MainWindow::onDecodedBatch(const DecodedBatch &batch)
 {
-    QVector<double> waveValues;
-    const QString decoded = decodeTextSmart(packet);
-    const QString raw = decoded.trimmed();
-    if (m_useWaveRegex) {
-        if (tryParseWaveValues(raw, waveValues) && !waveValues.isEmpty()) {
-            updateWaveformValues(waveValues);
-        }
-    }
-    // 当未启用波形正则或未能成功解析时，不再按字节值灌入波形，避免显示三角波
-
-    // 姿态显示只由解析结果更新，避免原始文本闪烁
-    if (m_attWorker && m_useAttRegex) {
-        double r, p, y;
-        if (tryParseAttitude(decoded, r, p, y)) {
-            QMetaObject::invokeMethod(m_attWorker, "appendAttitude", Qt::QueuedConnection,
-                                      Q_ARG(double, r), Q_ARG(double, p), Q_ARG(double, y));
+    // 数值提取已在 ExtractWorker 线程完成，这里只负责渲染
+    m_rxBytes += batch.byteCount;
+    m_rxDirty = true;
+
+    // 带着色区间的行不走 HTML：纯文本插入，颜色在排版时由 RecvHighlighter 按区间叠加
+    struct PendingLine {
+        QString html;
+        bool replaceLast = false;
+        const RecvLine* styled = nullptr;
+        QString prefix;
+        QColor prefixColor;
+        QString suffix;
+    };
+    QVector<PendingLine> linesToAppend;
+    QString logText;
+    const bool lineBreak = ui->chk_rev_line->isChecked();
+    for (const RecvLine &rl : batch.lines) {
+        // 新行到来即上一段重复结束，日志里补一条汇总（导出时已记过同样次数的不再重复记）
+        if (!rl.updatesPrevious) {
+            if (m_recvRunRepeat > 1 && m_recvRunRepeat > m_recvRunLogged) {
+                logText += QString::fromUtf8(u8"（上一行重复 %1 次）\n").arg(m_recvRunRepeat);
+            }
+            m_recvRunLogged = 0;
         }
-    }
-
-    m_rxBytes += packet.size();
-    updateStatusLabels();
-    updateCustomMatchDisplay(raw);
-
-    const qint64 nowMs = QDateTime::currentDateTime().toMSecsSinceEpoch();
-    QStringList linesToAppend;
-    auto appendLine = [this, &linesToAppend](const QString& seg, bool addBreak) {
-        QString line;
+        m_recvRunRepeat = rl.repeat;
+        PendingLine pl;
+        pl.replaceLast = rl.updatesPrevious;
+        const QString ts = QDateTime::fromMSecsSinceEpoch(rl.timestampMs).toString(QStringLiteral("[HH:mm:ss.zzz] "));
+        QString color;
         if (ui->chk_rev_time->isChecked()) {
-            const QString ts = QDateTime::currentDateTime().toString(QStringLiteral("[HH:mm:ss.zzz] "));
-            m_toggleTimestampColor = !m_toggleTimestampColor;
-            const QString color = m_toggleTimestampColor ? QStringLiteral("#007aff") : QStringLiteral("#ff6a00");
-            line += QStringLiteral("<span style=\"color:%1;\">%2</span> ").arg(color, ts.toHtmlEscaped());
+            if (!rl.updatesPrevious) m_toggleTimestampColor = !m_toggleTimestampColor;
+            color = m_toggleTimestampColor ? QStringLiteral("#007aff") : QStringLiteral("#ff6a00");
         }
-        QString htmlBody = m_enableAnsiColors ? ansiToHtml(seg) : seg.toHtmlEscaped();
-        line += htmlBody;
-        if (addBreak && ui->chk_rev_line->isChecked()) line += QStringLiteral("<br/>");
-        linesToAppend << line;
-    };
-
-    if (ui->chk_rev_hex->isChecked()) {
-        appendLine(formatAsHex(packet), ui->chk_rev_line->isChecked());
-    } else {
-        if (!ui->chk_rev_line->isChecked()) {
-            // 未勾选自动换行：每包直接输出，不额外换行
-            appendLine(decoded, false);
+        if (rl.repeat > 1) {
+            const QString lastTs = QDateTime::fromMSecsSinceEpoch(rl.lastMs).toString(QStringLiteral("HH:mm:ss.zzz"));
+            pl.suffix = QStringLiteral(" ×%1 (%2 ~ %3)").arg(rl.repeat).arg(ts.mid(1, 12), lastTs);
+        }
+        if (!rl.styles.isEmpty() && !m_enableAnsiColors) {
+            pl.styled = &rl;
+            if (!color.isEmpty()) {
+                pl.prefix = ts;
+                pl.prefixColor = QColor(color);
+            }
         } else {
-            // 勾选自动换行：仅按换行符换行，超时才按当前缓冲输出
-            QString combined = m_recvLineBuffer + decoded;
-            int startIdx = 0;
-            bool hasEol = false;
-            for (int i = 0; i < combined.size(); ++i) {
-                const QChar c = combined.at(i);
-                if (c == QChar('\r') || c == QChar('\n')) {
-                    hasEol = true;
-                    const bool crlf = (c == QChar('\r') && i + 1 < combined.size() && combined.at(i + 1) == QChar('\n'));
-                    QString seg = combined.mid(startIdx, i - startIdx);
-                    appendLine(seg, true);
-                    if (crlf) ++i;
-                    startIdx = i + 1;
-                }
+            QString line;
+            if (!color.isEmpty()) {
+                line += QStringLiteral("<span style=\"color:%1;\">%2</span> ").arg(color, ts.toHtmlEscaped());
             }
-            m_recvLineBuffer = combined.mid(startIdx);
-
-            // 无换行时不立即输出，等待后续；但若超时则按当前缓冲输出一行
-            const qint64 gap = (m_lastRecvFlushMs > 0) ? (nowMs - m_lastRecvFlushMs) : std::numeric_limits<qint64>::max();
-            if (!hasEol && !m_recvLineBuffer.isEmpty() && gap > 300) {
-                appendLine(m_recvLineBuffer, true);
-                m_recvLineBuffer.clear();
+            line += m_enableAnsiColors ? ansiToHtml(rl.text) : rl.text.toHtmlEscaped();
+            if (!pl.suffix.isEmpty()) {
+                line += QStringLiteral(" <span style=\"color:#888888;\">%1</span>").arg(pl.suffix.trimmed().toHtmlEscaped());
             }
+            if (rl.lineEnd && lineBreak) line += QStringLiteral("<br/>");
+            pl.html = line;
+        }
+        linesToAppend.append(pl);
+        if (!rl.updatesPrevious) {
+            if (ui->chk_rev_time->isChecked()) logText += ts;
+            logText += rl.text;
+            logText += QLatin1Char('\n');
         }
     }
 
@@ -690,12 +732,52 @@ void MainWindow::onPacketReceived(const QByteArray &packet)
     if (vs && !m_recvAutoFollow) restorePos = vs->value();
 
     m_inRecvAppend = true;
-    for (const QString& l : linesToAppend) {
-        ui->recvEdit->append(l);
+    QTextDocument* doc = ui->recvEdit->document();
+    for (const PendingLine& l : linesToAppend) {
+        const bool replace = l.replaceLast && m_recvRunBlockCount == doc->blockCount();
+        if (!l.styled) {
+            if (replace) {
+                // 重复行只刷新最后一个段落里的计数，不增加新行
+                QTextCursor c(doc);
+                c.movePosition(QTextCursor::End);
+                c.movePosition(QTextCursor::StartOfBlock, QTextCursor::KeepAnchor);
+                c.removeSelectedText();
+                c.insertHtml(l.html);
+            } else {
+                ui->recvEdit->append(l.html);
+            }
+        } else {
+            QTextCursor c(doc);
+            c.movePosition(QTextCursor::End);
+            if (replace) {
+                c.movePosition(QTextCursor::StartOfBlock, QTextCursor::KeepAnchor);
+                c.removeSelectedText();
+            } else if (!doc->isEmpty()) {
+                c.insertBlock(QTextBlockFormat(), QTextCharFormat());
+            }
+            QTextCharFormat plain;
+            if (!l.prefix.isEmpty()) {
+                QTextCharFormat tsFmt;
+                tsFmt.setForeground(l.prefixColor);
+                c.insertText(l.prefix, tsFmt);
+            }
+            c.insertText(l.styled->text, plain);
+            if (!l.suffix.isEmpty()) {
+                QTextCharFormat grey;
+                grey.setForeground(QColor(0x88, 0x88, 0x88));
+                c.insertText(l.suffix, grey);
+            }
+            if (l.styled->lineEnd && lineBreak) c.insertText(QString(QChar::LineSeparator), plain);
+            QTextBlock block = c.block();
+            block.setUserData(new StyleRunData(static_cast<int>(l.prefix.size()), l.styled->styles));
+            m_recvHighlighter->rehighlightBlock(block);
+        }
+        m_recvRunBlockCount = doc->blockCount();
     }
     m_inRecvAppend = false;
-    if (!linesToAppend.isEmpty()) {
-        m_lastRecvFlushMs = nowMs;
+    if (m_logWriter && !logText.isEmpty()) {
+        QMetaObject::invokeMethod(m_logWriter, "appendText", Qt::QueuedConnection,
+                                  Q_ARG(QString, logText));
     }
 
     if (m_recvAutoFollow) {
@@ -747,8 +829,6 @@ void MainWindow::onPortOpened()
     m_inRecvAppend = false;
     resetDecoderFromUi();
     m_hasAttData = false;
-    m_recvLineBuffer.clear();
-    m_lastRecvFlushMs = 0;
 
     m_lastAttText.clear();
     updateRecvSearchHighlights();
@@ -777,10 +857,9 @@ void MainWindow::onPortClosed()
     m_isPortOpen = false;
     m_recvAutoFollow = true;
     m_inRecvAppend = false;
+    flushRepeatSummary(true); // 解码器重置后重复段随之结束
     resetDecoderFromUi();
     m_hasAttData = false;
-    m_recvLineBuffer.clear();
-    m_lastRecvFlushMs = 0;
     m_lastAttText.clear();
     updateRecvSearchHighlights();
     ui->openBt->setText(QString::fromUtf8(u8"打开串口"));
@@ -941,19 +1020,44 @@ void MainWindow::saveLogs()
         QString::fromUtf8(u8"文本文件 (*.txt);;所有文件 (*.*)"));
     if (path.isEmpty()) return;
 
-    QFile file(path);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::warning(this, QString::fromUtf8(u8"保存失败"), QString::fromUtf8(u8"无法打开文件写入。"));
-        return;
+    if (!m_logWriter) return;
+    flushRepeatSummary(false); // 仍在进行的重复段先记下当前次数，导出内容才完整
+    // 接收数据已由后台持续落盘，这里只需收尾当前分段并拼接复制
+    QMetaObject::invokeMethod(m_logWriter, "exportTo", Qt::QueuedConnection,
+                              Q_ARG(QString, path),
+                              Q_ARG(QString, ui->sendEdit->toPlainText()));
+}
+
+void MainWindow::flushRepeatSummary(bool endRun)
+{
+    if (m_logWriter && m_recvRunRepeat > 1 && m_recvRunRepeat > m_recvRunLogged) {
+        QMetaObject::invokeMethod(m_logWriter, "appendText", Qt::QueuedConnection,
+                                  Q_ARG(QString, QString::fromUtf8(u8"（上一行重复 %1 次）\n").arg(m_recvRunRepeat)));
+        m_recvRunLogged = m_recvRunRepeat;
+    }
+    if (endRun) {
+        m_recvRunRepeat = 0;
+        m_recvRunLogged = 0;
     }
+}
 
-    QTextStream out(&file);
-    out << "===== Receive =====\n";
-    out << ui->recvEdit->toPlainText() << "\n";
-    out << "===== Send =====\n";
-    out << ui->sendEdit->toPlainText() << "\n";
-    file.close();
+void MainWindow::applyLogSettings()
+{
+    if (!m_logWriter) return;
+    QMetaObject::invokeMethod(m_logWriter, "setRotation", Qt::QueuedConnection,
+                              Q_ARG(qint64, qint64(m_logSegmentMb) * 1024 * 1024),
+                              Q_ARG(int, m_logSegmentMinutes * 60));
+    QMetaObject::invokeMethod(m_logWriter, "setCompression", Qt::QueuedConnection,
+                              Q_ARG(bool, m_logCompress));
+}
 
+void MainWindow::onLogExportFinished(const QString &path, bool ok, const QString &error)
+{
+    if (!ok) {
+        QMessageBox::warning(this, QString::fromUtf8(u8"保存失败"),
+                             QString::fromUtf8(u8"无法写入文件：") + error);
+        return;
+    }
     QMessageBox::information(this, QString::fromUtf8(u8"保存完成"), QString::fromUtf8(u8"已保存到：\n") + path);
 }
 bool MainWindow::eventFilter(QObject *watched, QEvent *event)
@@ -962,7 +1066,6 @@ bool MainWindow::eventFilter(QObject *watched, QEvent *event)
                          watched == ui->recvEdit->verticalScrollBar() || watched == ui->recvEdit->horizontalScrollBar());
     const bool isSend = (watched == ui->sendEdit || watched == ui->sendEdit->viewport() ||
                          watched == ui->sendEdit->verticalScrollBar() || watched == ui->sendEdit->horizontalScrollBar());
-    const bool isWave = (watched == m_wavePlot);
 
     if ((isRecv || isSend) && event->type() == QEvent::Wheel) {
         QWheelEvent *wheel = static_cast<QWheelEvent*>(event);
@@ -1065,53 +1168,9 @@ bool MainWindow::eventFilter(QObject *watched, QEvent *event)
             }
         }
     }
-    if (isWave) {
-        if (event->type() == QEvent::MouseButtonPress) {
-            QMouseEvent *me = static_cast<QMouseEvent*>(event);
-            if (me->button() == Qt::LeftButton && !(me->modifiers() & (Qt::ControlModifier | Qt::ShiftModifier | Qt::AltModifier))) {
-                m_waveAutoFollow = false;
-            }
-        } else if (event->type() == QEvent::MouseMove) {
-            QMouseEvent *me = static_cast<QMouseEvent*>(event);
-            if (m_waveGraph && !m_waveData.isEmpty()) {
-                const double xCoord = m_wavePlot->xAxis->pixelToCoord(me->pos().x());
-                double bestDist = std::numeric_limits<double>::max();
-                QCPGraphData best;
-                for (const auto &d : m_waveData) {
-                    double dist = std::abs(d.key - xCoord);
-                    if (dist < bestDist) {
-                        bestDist = dist;
-                        best = d;
-                    }
-                }
-                if (bestDist != std::numeric_limits<double>::max()) {
-                    QString tip = QStringLiteral("x: %1\ny: %2")
-                                      .arg(QString::number(best.key, 'f', 0))
-                                      .arg(QString::number(best.value, 'f', 3));
-                    QToolTip::showText(me->globalPos(), tip, m_wavePlot);
-                }
-            }
-        } else if (event->type() == QEvent::MouseButtonRelease) {
-            if (m_waveAutoFollow) return false;
-            if (!m_waveData.isEmpty() && m_wavePlot && m_wavePlot->xAxis) {
-                const double lastX = m_waveData.last().key;
-                const double viewRight = m_wavePlot->xAxis->range().upper;
-                if (viewRight >= lastX - 1e-6) {
-                    m_waveAutoFollow = true;
-                }
-            }
-        }
-    }
     return QMainWindow::eventFilter(watched, event);
 }
 
-QString MainWindow::decodeTextSmart(const QByteArray &data) const
-{
-    // Streamed UTF-8 decoder to handle split packets without回退到本地编码
-    QString out = m_textDecoder.decode(data);
-    return out;
-}
-
 void MainWindow::setAttitudeLabelFromQuat(const QQuaternion &q)
 {
     if (!m_attLabel) return;
@@ -1136,117 +1195,133 @@ void MainWindow::setAttitudeLabel(double rollDeg, double pitchDeg, double yawDeg
     }
 }
 
-bool MainWindow::tryParseWaveValues(const QString &text, QVector<double> &values) const
+void MainWindow::rebuildExtractRules()
 {
-    values.clear();
-    if (!m_useWaveRegex || m_waveRegexList.isEmpty()) return false;
-
-    for (const QString &pattern : m_waveRegexList) {
-        if (pattern.trimmed().isEmpty()) continue;
-        QRegularExpression re(pattern);
-        QRegularExpressionMatchIterator it = re.globalMatch(text);
-        QVector<double> tmp;
-        while (it.hasNext()) {
-            QRegularExpressionMatch m = it.next();
-            QString numStr;
-            if (m.lastCapturedIndex() >= 1) {
-                numStr = m.captured(1);
-            } else {
-                numStr = m.captured(0);
-            }
-            bool ok = false;
-            double v = numStr.toDouble(&ok);
-            if (ok) tmp.append(v);
-        }
-        if (!tmp.isEmpty()) {
-            values = tmp;
-            return true;
-        }
-    }
-    return false;
+    ExtractSettings settings;
+    settings.useWave = m_useWaveRegex;
+    settings.waveRegexList = m_waveRegexList;
+    settings.useAtt = m_useAttRegex;
+    settings.attRegex = m_attRegex;
+    settings.customRegexList = m_customRegexList;
+    settings.customEnableSpec = m_customRegexEnableSpec;
+    const ExtractRuleSet::Ptr rules = ExtractRuleSet::build(settings);
+    std::atomic_store(&m_extractRules, rules);
+    if (m_extractWorker) {
+        m_extractWorker->setRules(rules);
+    }
+    if (m_watchPanel) m_watchPanel->setCustomRules(rules->customLabels());
 }
 
-QVector<int> MainWindow::parseIndexSpec(const QString &spec, int maxCount) const
+bool MainWindow::applyBinarySchema(QString *error)
 {
-    QVector<int> result;
-    const QStringList tokens = spec.split(',', Qt::SkipEmptyParts);
-    for (QString token : tokens) {
-        token = token.trimmed();
-        if (token.contains('-')) {
-            const QStringList parts = token.split('-', Qt::SkipEmptyParts);
-            if (parts.size() == 2) {
-                bool ok1 = false, ok2 = false;
-                int a = parts.at(0).toInt(&ok1);
-                int b = parts.at(1).toInt(&ok2);
-                if (ok1 && ok2) {
-                    if (a > b) std::swap(a, b);
-                    for (int i = a; i <= b; ++i) {
-                        if (i >= 1 && i <= maxCount) result.append(i);
-                    }
-                }
-            }
-        } else {
-            bool ok = false;
-            int v = token.toInt(&ok);
-            if (ok && v >= 1 && v <= maxCount) result.append(v);
+    if (!m_frameWorker) return false;
+    if (!m_useBinarySchema || m_binarySchemaText.trimmed().isEmpty()) {
+        m_frameWorker->setDecoder(nullptr);
+        return true;
+    }
+    // "builtin 名称" 选用编译期定长解码器
+    const QString firstLine = m_binarySchemaText.trimmed().section('\n', 0, 0).simplified();
+    if (firstLine.startsWith(QLatin1String("builtin "))) {
+        const QString name = firstLine.section(' ', 1, 1);
+        std::shared_ptr<PacketDecoder> decoder = BuiltinDecoders::create(name);
+        if (!decoder && error) {
+            *error = QString::fromUtf8(u8"未知的内置解码器：%1（可用：%2）")
+                         .arg(name, BuiltinDecoders::names().join(QStringLiteral(", ")));
         }
+        m_frameWorker->setDecoder(decoder);
+        return decoder != nullptr;
     }
-    std::sort(result.begin(), result.end());
-    result.erase(std::unique(result.begin(), result.end()), result.end());
-    return result;
+
+    BinarySchema schema;
+    if (!BinarySchema::parse(m_binarySchemaText, schema, error)) {
+        m_frameWorker->setDecoder(nullptr);
+        return false;
+    }
+    m_frameWorker->setDecoder(std::make_shared<SchemaDecoder>(schema));
+    return true;
 }
 
-void MainWindow::updateCustomMatchDisplay(const QString &text)
+bool MainWindow::applyDerivedChannels(QString *error)
 {
-    if (!m_statusMatch) return;
-    if (!m_isPortOpen) {
-        m_statusMatch->clear();
-        return;
-    }
-    if (m_customRegexList.isEmpty()) {
-        m_statusMatch->clear();
-        return;
+    if (!m_extractWorker) return false;
+    // 提取规则、解码器和键值登记的通道不能再作为派生输出；以前的派生输出仍留在注册表中，不算重名
+    QStringList reserved;
+    QStringList existing = m_channels ? m_channels->channelNames() : QStringList();
+    if (const ExtractRuleSet::Ptr rules = extractRules()) existing << rules->channelNames();
+    for (const QString &name : std::as_const(existing)) {
+        if (!m_derivedOutputs.contains(name) && !reserved.contains(name)) reserved << name;
+    }
+    auto derived = std::make_shared<DerivedChannelSet>();
+    if (!DerivedChannelSet::compile(m_derivedSpecs, *derived, error, reserved)) {
+        m_extractWorker->setDerivedChannels(nullptr);
+        return false;
+    }
+    for (const QString &name : derived->outputNames()) {
+        if (!m_derivedOutputs.contains(name)) m_derivedOutputs << name;
+    }
+    m_extractWorker->setDerivedChannels(derived->isEmpty() ? nullptr : derived);
+    return true;
+}
+
+ExtractRuleSet::Ptr MainWindow::extractRules() const
+{
+    return std::atomic_load(&m_extractRules);
+}
+
+void MainWindow::updateCustomMatchDisplay(const QStringList &hits, const QVector<int> &rules)
+{
+    // 只记录最新命中，状态栏和监视表由定时器统一刷新，避免每包重排
+    m_pendingHits = hits;
+    m_hitsDirty = true;
+    if (m_watchPanel) m_watchPanel->setCustomHits(hits, rules);
+}
+
+void MainWindow::refreshStatusBar()
+{
+    if (m_rxDirty && m_statusRx) {
+        m_rxDirty = false;
+        m_statusRx->setText(QStringLiteral("RX: %1").arg(m_rxBytes));
     }
-    const QString enableSpec = m_customRegexEnableSpec.trimmed();
-    if (enableSpec == QStringLiteral("0")) {
+    if (!m_statusMatch || !m_hitsDirty) return;
+    m_hitsDirty = false;
+    const ExtractRuleSet::Ptr rules = extractRules();
+    if (!m_isPortOpen || !rules->customEnabled() || m_pendingHits.isEmpty()) {
         m_statusMatch->clear();
         return;
     }
-    const QVector<int> enabled = parseIndexSpec(enableSpec, m_customRegexList.size());
-    QVector<int> finalIdx = enabled;
-    if (finalIdx.isEmpty()) {
-        finalIdx.reserve(m_customRegexList.size());
-        for (int i = 0; i < m_customRegexList.size(); ++i) finalIdx.append(i + 1);
-    }
-
-    QStringList hits;
-    for (int idx : finalIdx) {
-        const QString pattern = m_customRegexList.value(idx - 1).trimmed();
-        if (pattern.isEmpty()) continue;
-        QRegularExpression re(pattern, QRegularExpression::MultilineOption);
-        if (!re.isValid()) continue;
-        QRegularExpressionMatchIterator it = re.globalMatch(text);
-        while (it.hasNext()) {
-            QRegularExpressionMatch m = it.next();
-            QString captured;
-            if (m.lastCapturedIndex() >= 1) {
-                captured = m.captured(1);
-            } else {
-                captured = m.captured(0);
-            }
-            if (!captured.isEmpty()) hits << captured;
-        }
+    QString joined = m_pendingHits.join(QString::fromUtf8(u8" | "));
+    if (joined.size() > 200) {
+        joined = joined.left(197) + QStringLiteral("...");
     }
+    m_statusMatch->setText(joined);
+}
 
-    if (hits.isEmpty()) {
-        m_statusMatch->clear();
-    } else {
-        QString joined = hits.join(QString::fromUtf8(u8" | "));
-        if (joined.size() > 200) {
-            joined = joined.left(197) + QStringLiteral("...");
-        }
-        m_statusMatch->setText(joined);
-    }
+void MainWindow::setupSpectrumTab()
+{
+    // 频谱在独立线程上计算，视图只负责设置和显示
+    m_spectrumThread = new QThread(this);
+    m_spectrumWorker = new SpectrumWorker(m_channels);
+    m_spectrumWorker->moveToThread(m_spectrumThread);
+    connect(m_spectrumThread, &QThread::finished, m_spectrumWorker, &QObject::deleteLater);
+    connect(m_channels, &ChannelRegistry::samplesAppended, m_spectrumWorker, &SpectrumWorker::ingest, Qt::QueuedConnection);
+
+    m_spectrumView = new SpectrumView;
+    connect(m_spectrumView, &SpectrumView::settingsChanged, m_spectrumWorker, &SpectrumWorker::configure, Qt::QueuedConnection);
+    connect(m_spectrumView, &SpectrumView::peakResetRequested, m_spectrumWorker, &SpectrumWorker::resetPeak, Qt::QueuedConnection);
+    connect(m_spectrumWorker, &SpectrumWorker::spectrumReady, m_spectrumView, &SpectrumView::setSpectrum, Qt::QueuedConnection);
+    m_spectrumThread->start();
+
+    m_spectrumView->setScheduler(m_renderScheduler);
+    m_spectrumView->setRegistry(m_channels);
+    ui->tabWidget->insertTab(ui->tabWidget->indexOf(m_waveView->parentWidget()) + 1, m_spectrumView, QString::fromUtf8(u8"频谱"));
+}
+
+void MainWindow::setupWatchTab()
+{
+    m_watchPanel = new WatchPanel;
+    m_watchPanel->setRegistry(m_channels);
+    if (const ExtractRuleSet::Ptr rules = extractRules()) m_watchPanel->setCustomRules(rules->customLabels());
+    ui->tabWidget->addTab(m_watchPanel, QString::fromUtf8(u8"监视"));
 }
 
 void MainWindow::showRecvSearch()
@@ -1440,7 +1515,7 @@ void MainWindow::openFormatDialog()
     v->addWidget(waveEnable);
 
     QPlainTextEdit* waveEdit = new QPlainTextEdit(&dlg);
-    waveEdit->setPlaceholderText(QString::fromUtf8(u8"例：(-?\\\\d+(?:\\\\.\\\\d+)?)"));
+    waveEdit->setPlaceholderText(QString::fromUtf8(u8"例：(-?\\\\d+(?:\\\\.\\\\d+)?)\n快速解析关键字：@numbers 全部数字，@csv 逗号分隔列，@kv key=value\n命名通道：temp=(?<temp>-?\\\\d+(?:\\\\.\\\\d+)?) 或 @csv:temp,hum,press"));
     waveEdit->setPlainText(m_waveRegexList.join(QStringLiteral("\n")));
     waveEdit->setFixedHeight(100);
     v->addWidget(waveEdit);
@@ -1469,6 +1544,65 @@ void MainWindow::openFormatDialog()
     customEnableEdit->setText(m_customRegexEnableSpec);
     v->addWidget(customEnableEdit);
 
+    QLabel* colorLabel = new QLabel(QString::fromUtf8(u8"着色规则（每行一条：颜色[,line] 正则；line 表示整行着色，有捕获组时只着色第一个捕获组。ANSI解析开启时不生效）"), &dlg);
+    colorLabel->setWordWrap(true);
+    v->addWidget(colorLabel);
+
+    QPlainTextEdit* colorEdit = new QPlainTextEdit(&dlg);
+    colorEdit->setPlaceholderText(QString::fromUtf8(u8"示例：\nred,line ERROR\n#f9a825 WARN\ncyan temp=([\\d.]+)"));
+    colorEdit->setPlainText(m_highlightRuleSpecs.join(QStringLiteral("\n")));
+    colorEdit->setFixedHeight(80);
+    v->addWidget(colorEdit);
+
+    QHBoxLayout* collapseRow = new QHBoxLayout;
+    QCheckBox* collapseEnable = new QCheckBox(QString::fromUtf8(u8"折叠连续重复行"), &dlg);
+    collapseEnable->setChecked(m_collapseRepeats);
+    QCheckBox* collapseDigits = new QCheckBox(QString::fromUtf8(u8"忽略数字/时间戳差异"), &dlg);
+    collapseDigits->setChecked(m_collapseIgnoreDigits);
+    collapseRow->addWidget(collapseEnable);
+    collapseRow->addWidget(collapseDigits);
+    collapseRow->addStretch();
+    v->addLayout(collapseRow);
+
+    QHBoxLayout* logRow = new QHBoxLayout;
+    QSpinBox* logSizeSpin = new QSpinBox(&dlg);
+    logSizeSpin->setRange(1, 4096);
+    logSizeSpin->setSuffix(QStringLiteral(" MB"));
+    logSizeSpin->setValue(m_logSegmentMb);
+    QSpinBox* logTimeSpin = new QSpinBox(&dlg);
+    logTimeSpin->setRange(0, 24 * 60);
+    logTimeSpin->setSuffix(QString::fromUtf8(u8" 分钟"));
+    logTimeSpin->setSpecialValueText(QString::fromUtf8(u8"不限"));
+    logTimeSpin->setValue(m_logSegmentMinutes);
+    QCheckBox* logCompress = new QCheckBox(QString::fromUtf8(u8"压缩"), &dlg);
+    logCompress->setChecked(m_logCompress);
+    logRow->addWidget(new QLabel(QString::fromUtf8(u8"日志分段："), &dlg));
+    logRow->addWidget(logSizeSpin);
+    logRow->addWidget(logTimeSpin);
+    logRow->addWidget(logCompress);
+    logRow->addStretch();
+    v->addLayout(logRow);
+
+    QCheckBox* binaryEnable = new QCheckBox(QString::fromUtf8(u8"启用二进制协议解码（结果写入通道，roll/pitch/yaw 驱动3D，wave 驱动波形）"), &dlg);
+    binaryEnable->setChecked(m_useBinarySchema);
+    v->addWidget(binaryEnable);
+
+    QPlainTextEdit* binaryEdit = new QPlainTextEdit(&dlg);
+    binaryEdit->setPlaceholderText(QString::fromUtf8(u8"示例：\nsync AA 55\nid 2 u8\nchecksum sum8 2\npacket 0x01 size 12\nfield roll 3 i16 scale 0.01\nfield pitch 5 i16 scale 0.01\nfield yaw 7 i16 scale 0.01\nfield wave 9 u16be\n或使用内置定长解码器：builtin imu6 / builtin attitude"));
+    binaryEdit->setPlainText(m_binarySchemaText);
+    binaryEdit->setFixedHeight(100);
+    v->addWidget(binaryEdit);
+
+    QLabel* derivedLabel = new QLabel(QString::fromUtf8(u8"派生通道（每行：名称 = 表达式；支持 + - * / abs sqrt min max avg(x,N) diff(x)，第一个引用的通道决定输出时刻）"), &dlg);
+    derivedLabel->setWordWrap(true);
+    v->addWidget(derivedLabel);
+
+    QPlainTextEdit* derivedEdit = new QPlainTextEdit(&dlg);
+    derivedEdit->setPlaceholderText(QString::fromUtf8(u8"示例：\npower = volt * amp\nsmooth = avg(temp, 20)"));
+    derivedEdit->setPlainText(m_derivedSpecs.join(QStringLiteral("\n")));
+    derivedEdit->setFixedHeight(60);
+    v->addWidget(derivedEdit);
+
     QHBoxLayout* btns = new QHBoxLayout;
     QPushButton* resetBtn = new QPushButton(QString::fromUtf8(u8"恢复默认"), &dlg);
     QPushButton* okBtn = new QPushButton(QString::fromUtf8(u8"确定"), &dlg);
@@ -1486,6 +1620,15 @@ void MainWindow::openFormatDialog()
         attEdit->setText(QString::fromUtf8(u8"([-+]?\\d+(?:\\.\\d+)?)[,\\s]+([-+]?\\d+(?:\\.\\d+)?)[,\\s]+([-+]?\\d+(?:\\.\\d+)?)"));
         customEdit->clear();
         customEnableEdit->setText(QStringLiteral("0"));
+        colorEdit->clear();
+        collapseEnable->setChecked(false);
+        collapseDigits->setChecked(false);
+        logSizeSpin->setValue(64);
+        logTimeSpin->setValue(60);
+        logCompress->setChecked(false);
+        binaryEnable->setChecked(false);
+        binaryEdit->clear();
+        derivedEdit->clear();
     });
     connect(okBtn, &QPushButton::clicked, &dlg, &QDialog::accept);
     connect(cancelBtn, &QPushButton::clicked, &dlg, &QDialog::reject);
@@ -1499,7 +1642,32 @@ void MainWindow::openFormatDialog()
         m_customRegexList = customEdit->toPlainText().split("\n", Qt::SkipEmptyParts);
         for (QString &s : m_customRegexList) s = s.trimmed();
         m_customRegexEnableSpec = customEnableEdit->text().trimmed();
-        updateCustomMatchDisplay(QString());
+        rebuildExtractRules();
+        updateCustomMatchDisplay(QStringList());
+        m_highlightRuleSpecs = colorEdit->toPlainText().split("\n", Qt::SkipEmptyParts);
+        for (QString &s : m_highlightRuleSpecs) s = s.trimmed();
+        QMetaObject::invokeMethod(m_decodeWorker, "setHighlightRules", Qt::QueuedConnection,
+                                  Q_ARG(QStringList, m_highlightRuleSpecs));
+        m_collapseRepeats = collapseEnable->isChecked();
+        m_collapseIgnoreDigits = collapseDigits->isChecked();
+        QMetaObject::invokeMethod(m_decodeWorker, "setCollapse", Qt::QueuedConnection,
+                                  Q_ARG(bool, m_collapseRepeats), Q_ARG(bool, m_collapseIgnoreDigits));
+        m_logSegmentMb = logSizeSpin->value();
+        m_logSegmentMinutes = logTimeSpin->value();
+        m_logCompress = logCompress->isChecked();
+        applyLogSettings();
+        m_useBinarySchema = binaryEnable->isChecked();
+        m_binarySchemaText = binaryEdit->toPlainText();
+        QString schemaError;
+        if (!applyBinarySchema(&schemaError)) {
+            QMessageBox::warning(this, QString::fromUtf8(u8"二进制协议"), schemaError);
+        }
+        m_derivedSpecs = derivedEdit->toPlainText().split("\n", Qt::SkipEmptyParts);
+        for (QString &s : m_derivedSpecs) s = s.trimmed();
+        QString derivedError;
+        if (!applyDerivedChannels(&derivedError)) {
+            QMessageBox::warning(this, QString::fromUtf8(u8"派生通道"), derivedError);
+        }
         if (!m_useAttRegex) {
             m_hasAttData = false;
         }
@@ -1527,81 +1695,26 @@ void MainWindow::setupWaveformTab()
         }
     }
 
-    m_wavePlot = new QCustomPlot(waveTab);
-    layout->addWidget(m_wavePlot);
-
-    m_waveGraph = m_wavePlot->addGraph();
-    m_waveGraph->setPen(QPen(Qt::green));
-    m_wavePlot->xAxis->setLabel("Sample");
-    m_wavePlot->yAxis->setLabel("Value");
-    m_wavePlot->yAxis->setRange(0, 260);
-    m_wavePlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
-
-    // 减少X轴刻度密度，避免拥挤
-    {
-        QSharedPointer<QCPAxisTicker> ticker(new QCPAxisTicker);
-        ticker->setTickStepStrategy(QCPAxisTicker::tssMeetTickCount);
-        ticker->setTickCount(6);
-        m_wavePlot->xAxis->setTicker(ticker);
-        m_wavePlot->xAxis->setNumberFormat("f");
-        m_wavePlot->xAxis->setNumberPrecision(0);
-    }
-
-    // Match background to current theme
-    const QColor bg = waveTab->palette().color(QPalette::Base);
-    m_wavePlot->setBackground(bg);
-    if (m_wavePlot->axisRect()) {
-        m_wavePlot->axisRect()->setBackground(bg);
-    }
-
-    connect(m_wavePlot, &QCustomPlot::mouseDoubleClick, this, [this]() {
-        m_waveAutoFollow = true;
-    });
-
-    m_wavePlot->installEventFilter(this);
-}
-
-void MainWindow::updateWaveform(const QVector<QPointF> &points)
-{
-    if (!m_waveGraph) return;
-    for (const QPointF &p : points) {
-        m_waveData.append(QCPGraphData{p.x(), p.y()});
-    }
-    if (m_waveData.size() > m_waveMaxPoints) {
-        m_waveData.erase(m_waveData.begin(), m_waveData.begin() + (m_waveData.size() - m_waveMaxPoints));
-    }
-    m_waveGraph->data()->set(m_waveData, true);
-    if (!m_waveData.isEmpty()) {
-        if (m_waveAutoFollow) {
-            const double xmax = m_waveData.last().key;
-            const double xmin = std::max(0.0, xmax - m_waveViewWidth);
-            m_waveRangeUpdating = true;
-            m_wavePlot->xAxis->setRange(xmin, xmax);
-            m_waveRangeUpdating = false;
-        }
+    if (!m_renderScheduler) {
+        m_renderScheduler = new RenderScheduler(this);
+        connect(m_renderScheduler, &RenderScheduler::statsUpdated, this, [this](const RenderScheduler::FrameStats &st) {
+            // 没有重绘的一秒不显示，免得空闲时状态栏一直跳动
+            if (st.frames == 0 && st.dropped == 0) {
+                m_statusRender->clear();
+                return;
+            }
+            m_statusRender->setText(QString::fromUtf8(u8"绘图 %1 fps  %2/%3 ms  丢帧 %4")
+                                        .arg(st.frames)
+                                        .arg(st.averageMs, 0, 'f', 1)
+                                        .arg(st.maxMs, 0, 'f', 1)
+                                        .arg(st.dropped));
+        });
     }
-    m_wavePlot->replot(QCustomPlot::rpQueuedReplot);
-}
 
-void MainWindow::updateWaveformValues(const QVector<double> &values)
-{
-    if (!m_waveGraph) return;
-    for (double v : values) {
-        m_waveData.append(QCPGraphData{m_waveX, v});
-        m_waveX += 1.0;
-    }
-    if (m_waveData.size() > m_waveMaxPoints) {
-        m_waveData.erase(m_waveData.begin(), m_waveData.begin() + (m_waveData.size() - m_waveMaxPoints));
-    }
-    m_waveGraph->data()->set(m_waveData, true);
-    if (!m_waveData.isEmpty() && m_waveAutoFollow) {
-        const double xmax = m_waveData.last().key;
-        const double xmin = std::max(0.0, xmax - m_waveViewWidth);
-        m_waveRangeUpdating = true;
-        m_wavePlot->xAxis->setRange(xmin, xmax);
-        m_waveRangeUpdating = false;
-    }
-    m_wavePlot->replot(QCustomPlot::rpQueuedReplot);
+    m_waveView = new WaveformView(waveTab);
+    m_waveView->setRegistry(m_channels);
+    m_waveView->setScheduler(m_renderScheduler);
+    layout->addWidget(m_waveView);
 }
 
 void MainWindow::setup3DTab()
@@ -1753,34 +1866,3 @@ void MainWindow::updateAttitude(double rollDeg, double pitchDeg, double yawDeg)
         setAttitudeLabel(rollDeg, pitchDeg, yawDeg);
     }
 }
-
-bool MainWindow::tryParseAttitude(const QString &text, double &roll, double &pitch, double &yaw) const
-{
-    if (!m_useAttRegex) return false;
-    QString str = text.trimmed();
-    if (m_useAttRegex && !m_attRegex.isEmpty()) {
-        QRegularExpression re(m_attRegex);
-        QRegularExpressionMatch m = re.match(str);
-        if (m.hasMatch() && m.lastCapturedIndex() >= 3) {
-            bool ok1=false, ok2=false, ok3=false;
-            double r = m.captured(1).toDouble(&ok1);
-            double p = m.captured(2).toDouble(&ok2);
-            double y = m.captured(3).toDouble(&ok3);
-            if (ok1 && ok2 && ok3) {
-                roll = r; pitch = p; yaw = y;
-                return true;
-            }
-        }
-    }
-    const QStringList parts = str.split(',', Qt::SkipEmptyParts);
-    if (parts.size() != 3) return false;
-    bool ok1=false, ok2=false, ok3=false;
-    double r = parts[0].toDouble(&ok1);
-    double p = parts[1].toDouble(&ok2);
-    double y = parts[2].toDouble(&ok3);
-    if (!(ok1 && ok2 && ok3)) return false;
-    roll = r;
-    pitch = p;
-    yaw = y;
-    return true;
-}
@@ -33,8 +33,19 @@
 #include <Qt3DExtras/QSphereMesh>
 #include <Qt3DExtras/QTorusMesh>
 #include "attitudeworker.h"
+#include "channelregistry.h"
+#include "decodeworker.h"
+#include "extractrules.h"
+#include "extractworker.h"
+#include "framedecodeworker.h"
+#include "highlightrules.h"
+#include "logwriter.h"
 #include "qcustomplot/qcustomplot.h"
-#include "waveformworker.h"
+#include "renderscheduler.h"
+#include "spectrumview.h"
+#include "spectrumworker.h"
+#include "watchpanel.h"
+#include "waveformview.h"
 #include "serialportworker.h"
 #include "serialsettings.h"
 
@@ -54,17 +65,28 @@ public:
 private slots:
     void on_openButton_clicked();
     void on_sendButton_clicked();
-    void onPacketReceived(const QByteArray &packet);
+    void onDecodedBatch(const DecodedBatch &batch);
     void onErrorOccurred(const QString &error);
     void onFatalError(const QString &error);
     void onPortOpened();
     void onPortClosed();
+    void onLogExportFinished(const QString &path, bool ok, const QString &error);
+    void updateCustomMatchDisplay(const QStringList &hits, const QVector<int> &rules = QVector<int>());
     
 private:
     Ui::MainWindow *ui;
 
     QThread* m_serialThread;
     SerialPortWorker* m_serialWorker;
+    QThread* m_decodeThread = nullptr;
+    DecodeWorker* m_decodeWorker = nullptr;
+    QThread* m_extractThread = nullptr;
+    ExtractWorker* m_extractWorker = nullptr;
+    ChannelRegistry* m_channels = nullptr; // 提取出的命名通道，各视图按通道订阅
+    QThread* m_frameThread = nullptr;
+    FrameDecodeWorker* m_frameWorker = nullptr;
+    QThread* m_spectrumThread = nullptr;
+    SpectrumWorker* m_spectrumWorker = nullptr; // 频谱计算，按选定通道订阅注册表
 
     QMutex m_queueMutex;
     QList<QByteArray> m_writeQueue;
@@ -77,12 +99,15 @@ private:
     QLabel* m_statusRx = nullptr;
     QLabel* m_statusTx = nullptr;
     QLabel* m_statusMatch = nullptr;
-    QCustomPlot* m_wavePlot = nullptr;
-    QCPGraph* m_waveGraph = nullptr;
-    QVector<QCPGraphData> m_waveData;
-    int m_waveMaxPoints = 3000;
-    QThread* m_waveThread = nullptr;
-    WaveformWorker* m_waveWorker = nullptr;
+    QLabel* m_statusRender = nullptr; // 绘图帧率、帧耗时与丢帧，每秒更新
+    QTimer* m_statusRefreshTimer = nullptr; // 状态栏接收计数与命中文本按固定频率刷新
+    QStringList m_pendingHits;
+    bool m_hitsDirty = false;
+    bool m_rxDirty = false;
+    WatchPanel* m_watchPanel = nullptr;
+    RenderScheduler* m_renderScheduler = nullptr; // 各绘图视图共用
+    WaveformView* m_waveView = nullptr;
+    SpectrumView* m_spectrumView = nullptr;
     QWidget* m_tab3d = nullptr;
     Qt3DExtras::Qt3DWindow* m_3dWindow = nullptr;
     QWidget* m_3dContainer = nullptr;
@@ -91,11 +116,12 @@ private:
     Qt3DCore::QEntity* m_modelEntity = nullptr;
     QThread* m_attThread = nullptr;
     AttitudeWorker* m_attWorker = nullptr;
+    QThread* m_logThread = nullptr;
+    LogWriter* m_logWriter = nullptr;
+    int m_logSegmentMb = 64;
+    int m_logSegmentMinutes = 60;
+    bool m_logCompress = false;
     QLabel* m_attLabel = nullptr;
-    bool m_waveAutoFollow = true;
-    bool m_waveRangeUpdating = false;
-    double m_waveViewWidth = 300.0; // 展示区只看最近300个采样，避免挤在一起
-    double m_waveX = 0.0;
     qint64 m_rxBytes = 0;
     qint64 m_txBytes = 0;
     QStringList m_knownPorts;
@@ -111,6 +137,7 @@ private:
     QString m_customRegexEnableSpec;
     bool m_useWaveRegex = false;
     bool m_useAttRegex = false;
+    ExtractRuleSet::Ptr m_extractRules; // 只通过 std::atomic_load/atomic_store 访问
     QToolButton* m_formatBtn = nullptr;
     bool m_recvAutoFollow = true;
     bool m_inRecvAppend = false;
@@ -122,7 +149,6 @@ private:
     QToolButton* m_recvSearchPrev = nullptr;
     QToolButton* m_themeBtn = nullptr;
     bool m_darkTheme = true;
-    mutable QStringDecoder m_textDecoder{QStringDecoder::Utf8};
     QString m_decoderName = QStringLiteral("UTF-8");
     QString m_lastAttText;
     Qt3DExtras::QPhongMaterial* m_baseMat = nullptr;
@@ -148,20 +174,22 @@ private:
     void updateStatusLabels();
     void checkPortHotplug();
     void saveLogs();
-    QString decodeTextSmart(const QByteArray& data) const;
+    void applyLogSettings();
+    void flushRepeatSummary(bool endRun); // 把仍在进行的重复段汇总写进日志
     void resetDecoderFromUi();
     void applyTheme(bool dark);
     void setupWaveformTab();
-    void updateWaveform(const QVector<QPointF>& points);
-    void updateWaveformValues(const QVector<double>& values);
+    void setupSpectrumTab();
+    void setupWatchTab();
+    void refreshStatusBar();
     void setup3DTab();
     void updateAttitude(double rollDeg, double pitchDeg, double yawDeg);
     void setAttitudeLabelFromQuat(const QQuaternion& q);
     void setAttitudeLabel(double rollDeg, double pitchDeg, double yawDeg);
-    bool tryParseAttitude(const QString& text, double &roll, double &pitch, double &yaw) const;
-    bool tryParseWaveValues(const QString &text, QVector<double> &values) const;
-    void updateCustomMatchDisplay(const QString &text);
-    QVector<int> parseIndexSpec(const QString &spec, int maxCount) const;
+    void rebuildExtractRules();
+    bool applyBinarySchema(QString *error = nullptr);
+    bool applyDerivedChannels(QString *error = nullptr);
+    ExtractRuleSet::Ptr extractRules() const;
     void openFormatDialog();
     void showRecvSearch();
     void hideRecvSearch();
@@ -170,8 +198,17 @@ private:
     QString ansiToHtml(const QString& text) const;
     QString cssColorForCode(int code) const;
     bool m_enableAnsiColors = false;
+    QStringList m_highlightRuleSpecs;
+    bool m_useBinarySchema = false;
+    QString m_binarySchemaText;
+    QStringList m_derivedSpecs;
+    QStringList m_derivedOutputs; // 曾作为派生输出登记过的通道名
+    RecvHighlighter* m_recvHighlighter = nullptr;
+    bool m_collapseRepeats = false;
+    bool m_collapseIgnoreDigits = false;
+    int m_recvRunRepeat = 0;
+    int m_recvRunLogged = 0; // 当前重复段已写进日志的次数（导出时提前记录）
+    int m_recvRunBlockCount = -1;
     QString normalizeAnsiEscapes(const QString& text) const;
-    QString m_recvLineBuffer;
-    qint64 m_lastRecvFlushMs = 0;
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,129 @@
+#include "numericscanner.h"
+
+#include <charconv>
+
+namespace NumericScanner {
+
+namespace {
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+inline bool isKeyChar(char c)
+{
+    return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'
+           || static_cast<unsigned char>(c) >= 0x80; // 允许中文等 UTF-8 键名
+}
+
+// 从 p 开始解析一个数字（可带 +/- 号；exponent 为 true 时可带指数，与 QString::toDouble 一致接受 1e-3），
+// 成功返回结束位置，失败返回 nullptr
+const char *parseNumber(const char *p, const char *end, double &value, bool exponent = true)
+{
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = (*p == '-');
+        ++p;
+    }
+    if (p >= end || !isDigit(*p)) return nullptr;
+    const std::from_chars_result r = std::from_chars(p, end, value, exponent ? std::chars_format::general : std::chars_format::fixed);
+    if (r.ec != std::errc()) return nullptr;
+    if (neg) value = -value;
+    return r.ptr;
+}
+} // namespace
+
+std::size_t scanNumbers(const char *p, std::size_t n, double *out, std::size_t cap, std::size_t *consumed, bool exponent)
+{
+    const char *const begin = p;
+    const char *const end = p + n;
+    std::size_t count = 0;
+    while (p < end && count < cap) {
+        if (!isDigit(*p)) {
+            ++p;
+            continue;
+        }
+        const char *start = p;
+        if (start > begin && start[-1] == '-') --start;
+        double v = 0.0;
+        const char *next = parseNumber(start, end, v, exponent);
+        if (!next) {
+            ++p;
+            continue;
+        }
+        out[count++] = v;
+        p = next;
+    }
+    // 停在上一个数之后，续扫时负号仍在输入范围内
+    if (consumed) *consumed = static_cast<std::size_t>(p - begin);
+    return count;
+}
+
+std::size_t scanCsv(const char *p, std::size_t n, double *out, std::size_t cap, char sep, bool *ok,
+                    std::size_t *consumed)
+{
+    const char *const begin = p;
+    const char *const end = p + n;
+    std::size_t count = 0;
+    if (ok) *ok = true;
+    while (p < end) {
+        const char *fieldEnd = p;
+        while (fieldEnd < end && *fieldEnd != sep) ++fieldEnd;
+
+        const char *a = p;
+        const char *b = fieldEnd;
+        while (a < b && isSpace(*a)) ++a;
+        while (b > a && isSpace(b[-1])) --b;
+        if (a < b) {
+            if (count >= cap && consumed) {
+                *consumed = static_cast<std::size_t>(p - begin); // 从这一列继续
+                return count;
+            }
+            double v = 0.0;
+            const char *next = parseNumber(a, b, v);
+            if (!next || next != b || count >= cap) {
+                if (ok) *ok = false;
+                return 0;
+            }
+            out[count++] = v;
+        }
+        p = (fieldEnd < end) ? fieldEnd + 1 : end;
+    }
+    if (consumed) *consumed = n;
+    return count;
+}
+
+std::size_t scanKeyValues(const char *p, std::size_t n, KeyValue *out, std::size_t cap, std::size_t *consumed)
+{
+    const char *const begin = p;
+    const char *const end = p + n;
+    std::size_t count = 0;
+    while (p < end && count < cap) {
+        if (!isKeyChar(*p)) {
+            ++p;
+            continue;
+        }
+        const char *keyStart = p;
+        while (p < end && isKeyChar(*p)) ++p;
+        const char *keyEnd = p;
+
+        const char *q = p;
+        while (q < end && (*q == ' ' || *q == '\t')) ++q;
+        if (q >= end || (*q != '=' && *q != ':')) continue;
+        ++q;
+        while (q < end && (*q == ' ' || *q == '\t')) ++q;
+
+        double v = 0.0;
+        const char *next = parseNumber(q, end, v);
+        if (!next) {
+            p = q;
+            continue;
+        }
+        out[count].key = keyStart;
+        out[count].keyLen = static_cast<std::size_t>(keyEnd - keyStart);
+        out[count].value = v;
+        ++count;
+        p = next;
+    }
+    if (consumed) *consumed = static_cast<std::size_t>(p - begin);
+    return count;
+}
+
+} // namespace NumericScanner
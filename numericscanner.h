@@ -0,0 +1,34 @@
+#ifndef NUMERICSCANNER_H
+#define NUMERICSCANNER_H
+
+#include <cstddef>
+
+// 不依赖正则的数值扫描：直接在 UTF-8 字节上用 std::from_chars 解析，
+// 结果写入调用方提供的数组，不做任何堆分配。返回写入的个数（不超过 cap）。
+// 给出 consumed 时，数组写满后停在下一个值之前并把已处理的字节数写入 *consumed，
+// 调用方从该位置继续扫描即可取完整段输入；输入用完时 *consumed 为 n。
+namespace NumericScanner {
+
+struct KeyValue {
+    const char *key = nullptr;
+    std::size_t keyLen = 0;
+    double value = 0.0;
+};
+
+// 行内所有数字，与默认波形规则 (-?\d+(?:\.\d+)?) 的结果一致："3E8" 是 3 和 8。
+// exponent 为 true 时（@numbers）另外接受指数写法，"3E8" 是 3e8
+std::size_t scanNumbers(const char *p, std::size_t n, double *out, std::size_t cap,
+                        std::size_t *consumed = nullptr, bool exponent = false);
+
+// 逗号分隔列：跳过空列，列两端空白忽略；任一列不是数字时返回 0 并置 *ok = false。
+// 未给出 consumed 时列数超过 cap 也视为失败
+std::size_t scanCsv(const char *p, std::size_t n, double *out, std::size_t cap,
+                    char sep = ',', bool *ok = nullptr, std::size_t *consumed = nullptr);
+
+// key=value / key: value 形式，key 为字母数字下划线序列
+std::size_t scanKeyValues(const char *p, std::size_t n, KeyValue *out, std::size_t cap,
+                          std::size_t *consumed = nullptr);
+
+} // namespace NumericScanner
+
+#endif // NUMERICSCANNER_H
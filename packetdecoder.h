@@ -0,0 +1,140 @@
+#ifndef PACKETDECODER_H
+#define PACKETDECODER_H
+
+#include <QStringList>
+#include <QtGlobal>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// 二进制帧解码接口：串口原始字节流经 FrameDecodeWorker 分帧后，
+// 由具体的解码器（按协议描述解释执行的 SchemaDecoder，或编译期生成的定长解码器）
+// 把字段值写入通道。解码器只在解码线程上使用，不需要加锁。
+
+// 一帧解码完成时调用：从 firstChannel 开始的 count 个通道各得到一个值
+class FrameSink
+{
+public:
+    virtual ~FrameSink() = default;
+    virtual void frame(int firstChannel, const double *values, int count) = 0;
+};
+
+struct DecoderStats {
+    quint64 frames = 0;
+    quint64 checksumErrors = 0;
+    quint64 skippedBytes = 0; // 重新同步时丢弃的字节
+};
+
+class PacketDecoder
+{
+public:
+    virtual ~PacketDecoder() = default;
+
+    // 解码器输出的全部通道（序号即 FrameSink::frame 中的通道号）
+    virtual QStringList channelNames() const = 0;
+
+    // 从 data 中解出所有完整帧，返回已消耗的字节数；
+    // 末尾不完整的帧不消耗，由调用方保留到下一包数据
+    virtual std::size_t decode(const char *data, std::size_t size, FrameSink &sink) = 0;
+
+    const DecoderStats &stats() const { return m_stats; }
+
+protected:
+    DecoderStats m_stats;
+};
+
+namespace PacketCodec {
+
+// 小端/大端定长读取（memcpy 避免未对齐访问）
+template <typename T>
+inline T load(const char *p, bool bigEndian)
+{
+    static_assert(sizeof(T) <= 8, "unsupported field size");
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, p, sizeof(T));
+    const bool swap = (Q_BYTE_ORDER == Q_LITTLE_ENDIAN) == bigEndian;
+    if (swap) {
+        for (std::size_t i = 0; i < sizeof(T) / 2; ++i) {
+            const unsigned char tmp = bytes[i];
+            bytes[i] = bytes[sizeof(T) - 1 - i];
+            bytes[sizeof(T) - 1 - i] = tmp;
+        }
+    }
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+enum class Checksum {
+    None,
+    Sum8,
+    Xor8,
+    Crc16Modbus, // 帧尾两字节，低字节在前
+};
+
+constexpr int checksumSize(Checksum kind)
+{
+    return kind == Checksum::None ? 0 : (kind == Checksum::Crc16Modbus ? 2 : 1);
+}
+
+inline constexpr std::array<std::uint16_t, 256> makeCrc16Table()
+{
+    std::array<std::uint16_t, 256> table{};
+    for (int i = 0; i < 256; ++i) {
+        std::uint16_t crc = static_cast<std::uint16_t>(i);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? static_cast<std::uint16_t>((crc >> 1) ^ 0xA001) : static_cast<std::uint16_t>(crc >> 1);
+        }
+        table[static_cast<std::size_t>(i)] = crc;
+    }
+    return table;
+}
+
+inline constexpr std::array<std::uint16_t, 256> kCrc16Table = makeCrc16Table();
+
+// 校验 [begin, end) 区间，校验值紧随其后
+inline bool verifyChecksum(Checksum kind, const unsigned char *begin, const unsigned char *end)
+{
+    switch (kind) {
+    case Checksum::None:
+        return true;
+    case Checksum::Sum8: {
+        std::uint8_t sum = 0;
+        for (const unsigned char *p = begin; p < end; ++p) sum = static_cast<std::uint8_t>(sum + *p);
+        return sum == *end;
+    }
+    case Checksum::Xor8: {
+        std::uint8_t x = 0;
+        for (const unsigned char *p = begin; p < end; ++p) x ^= *p;
+        return x == *end;
+    }
+    case Checksum::Crc16Modbus: {
+        std::uint16_t crc = 0xFFFF;
+        for (const unsigned char *p = begin; p < end; ++p) {
+            crc = static_cast<std::uint16_t>((crc >> 8) ^ kCrc16Table[(crc ^ *p) & 0xFF]);
+        }
+        return (crc & 0xFF) == end[0] && (crc >> 8) == end[1];
+    }
+    }
+    return false;
+}
+
+// 查找帧头，找不到时返回 size
+inline std::size_t findSync(const char *data, std::size_t size, const char *sync, std::size_t syncLen)
+{
+    if (syncLen == 0) return 0;
+    std::size_t pos = 0;
+    while (pos + syncLen <= size) {
+        const void *hit = std::memchr(data + pos, sync[0], size - pos - syncLen + 1);
+        if (!hit) return size;
+        pos = static_cast<std::size_t>(static_cast<const char *>(hit) - data);
+        if (std::memcmp(data + pos, sync, syncLen) == 0) return pos;
+        ++pos;
+    }
+    return size;
+}
+
+} // namespace PacketCodec
+
+#endif // PACKETDECODER_H
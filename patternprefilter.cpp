@@ -0,0 +1,196 @@
+#include "patternprefilter.h"
+
+#include <cctype>
+#include <queue>
+
+namespace {
+bool isFlagChar(char c)
+{
+    return c == 'i' || c == 'm' || c == 's' || c == 'x' || c == 'n'
+           || c == 'U' || c == 'J' || c == '-' || c == '^';
+}
+
+// 带参数的转义：\x41 \u0041 \o{101} \cA \k<name> \g1 \p{L} \N{U+41} \1 \Q...\E 等，
+// 后面的字符是参数而不是字面量，这类规则不做预筛
+bool escapeTakesArgument(char d)
+{
+    return (d >= '0' && d <= '9') || d == 'x' || d == 'u' || d == 'o' || d == 'c' || d == 'k' || d == 'g'
+           || d == 'p' || d == 'P' || d == 'N' || d == 'Q' || d == 'E';
+}
+
+// 跳过从 pattern[i] == '[' 开始的字符类，返回结尾 ']' 的位置（没有结尾时为 n）。
+// 类中的 [:digit:] [=a=] [.a.] 自带方括号，不能在它们的 ']' 处结束
+std::size_t skipClass(const std::string &pattern, std::size_t i)
+{
+    const std::size_t n = pattern.size();
+    std::size_t j = i + 1;
+    if (j < n && pattern[j] == '^') ++j;
+    if (j < n && pattern[j] == ']') ++j; // 紧跟在开头的 ']' 是字面量
+    for (; j < n && pattern[j] != ']'; ++j) {
+        if (pattern[j] == '\\') {
+            ++j;
+        } else if (pattern[j] == '[' && j + 1 < n
+                   && (pattern[j + 1] == ':' || pattern[j + 1] == '=' || pattern[j + 1] == '.')) {
+            const char kind = pattern[j + 1];
+            std::size_t k = j + 2;
+            while (k + 1 < n && !(pattern[k] == kind && pattern[k + 1] == ']')) ++k;
+            if (k + 1 >= n) return n;
+            j = k + 1; // 停在内层的 ']'
+        }
+    }
+    return j;
+}
+
+// 删除末尾一个完整的 UTF-8 字符（量词只作用于它）
+void popCodePoint(std::string &s)
+{
+    while (!s.empty() && (static_cast<unsigned char>(s.back()) & 0xC0) == 0x80) s.pop_back();
+    if (!s.empty()) s.pop_back();
+}
+} // namespace
+
+std::string PatternPrefilter::requiredLiteral(const std::string &pattern)
+{
+    std::string best;
+    std::string cur;
+    auto flush = [&]() {
+        if (cur.size() > best.size()) best = cur;
+        cur.clear();
+    };
+
+    const std::size_t n = pattern.size();
+    int depth = 0;
+    bool prevQuant = false;
+    for (std::size_t i = 0; i < n; ++i) {
+        const char c = pattern[i];
+        if (c == '\\') {
+            prevQuant = false;
+            if (i + 1 >= n) break;
+            const char d = pattern[++i];
+            if (escapeTakesArgument(d)) return std::string();
+            if (std::isalnum(static_cast<unsigned char>(d))) {
+                flush(); // \d \w \b \n 等，不是字面量
+            } else if (depth == 0) {
+                cur += d;
+            }
+            continue;
+        }
+        if (c == '[') {
+            prevQuant = false;
+            flush();
+            i = skipClass(pattern, i);
+            continue;
+        }
+        if (c == '(') {
+            prevQuant = false;
+            flush();
+            // 内联选项里有忽略大小写或扩展模式时，字面量不可靠
+            if (i + 2 < n && pattern[i + 1] == '?' && isFlagChar(pattern[i + 2])) {
+                for (std::size_t j = i + 2; j < n && pattern[j] != ')' && pattern[j] != ':'; ++j) {
+                    if (pattern[j] == 'i' || pattern[j] == 'x') return std::string();
+                }
+            }
+            ++depth;
+            continue;
+        }
+        if (c == ')') {
+            prevQuant = false;
+            flush();
+            if (depth > 0) --depth;
+            continue;
+        }
+        if (c == '|') {
+            if (depth == 0) return std::string();
+            continue;
+        }
+        if (c == '*' || c == '?' || c == '{') {
+            if (c == '{') {
+                while (i < n && pattern[i] != '}') ++i;
+            } else if (prevQuant) {
+                continue; // 惰性/占有量词的后缀
+            }
+            popCodePoint(cur);
+            flush();
+            prevQuant = true;
+            continue;
+        }
+        if (c == '+') {
+            if (!prevQuant) flush();
+            prevQuant = true;
+            continue;
+        }
+        prevQuant = false;
+        if (c == '.' || c == '^' || c == '$') {
+            flush();
+            continue;
+        }
+        if (depth == 0) cur += c;
+    }
+    flush();
+    return best;
+}
+
+int PatternPrefilter::addRule(const std::string &pattern)
+{
+    const int id = static_cast<int>(m_always.size());
+    const std::string literal = requiredLiteral(pattern);
+    m_always.push_back(literal.empty() ? 1 : 0);
+    if (literal.empty()) return id;
+
+    int state = 0;
+    for (unsigned char ch : literal) {
+        int next = m_nodes[state].next[ch];
+        if (next < 0) {
+            next = static_cast<int>(m_nodes.size());
+            m_nodes.emplace_back();
+            m_nodes[state].next[ch] = next;
+        }
+        state = next;
+    }
+    m_nodes[state].out.push_back(id);
+    m_hasLiterals = true;
+    return id;
+}
+
+void PatternPrefilter::build()
+{
+    // BFS 求失败指针，同时把转移补全为 DFA，扫描时每个字节只查一次表
+    std::queue<int> queue;
+    for (int ch = 0; ch < 256; ++ch) {
+        int &next = m_nodes[0].next[ch];
+        if (next < 0) {
+            next = 0;
+        } else {
+            m_nodes[next].fail = 0;
+            queue.push(next);
+        }
+    }
+    while (!queue.empty()) {
+        const int state = queue.front();
+        queue.pop();
+        const int fail = m_nodes[state].fail;
+        const std::vector<int> &inherited = m_nodes[fail].out;
+        m_nodes[state].out.insert(m_nodes[state].out.end(), inherited.begin(), inherited.end());
+        for (int ch = 0; ch < 256; ++ch) {
+            const int next = m_nodes[state].next[ch];
+            if (next < 0) {
+                m_nodes[state].next[ch] = m_nodes[fail].next[ch];
+            } else {
+                m_nodes[next].fail = m_nodes[fail].next[ch];
+                queue.push(next);
+            }
+        }
+    }
+}
+
+void PatternPrefilter::scan(const char *p, std::size_t n, std::vector<char> &candidates) const
+{
+    candidates = m_always;
+    if (!m_hasLiterals) return;
+
+    int state = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        state = m_nodes[state].next[static_cast<unsigned char>(p[i])];
+        for (int id : m_nodes[state].out) candidates[id] = 1;
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef PATTERNPREFILTER_H
+#define PATTERNPREFILTER_H
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// 多规则字面量预筛：从每条正则中取出一个“必然出现”的字面量片段，
+// 全部片段编译成一个 Aho-Corasick 自动机。一行文本只扫描一遍，
+// 得到可能命中的规则集合，之后只对这些规则运行正则取捕获组。
+// 取不出字面量的规则（如纯 \d+、含顶层 | 或忽略大小写）始终视为候选。
+class PatternPrefilter
+{
+public:
+    // pattern 为 UTF-8 编码的正则，返回规则序号
+    int addRule(const std::string &pattern);
+    void build();
+
+    int ruleCount() const { return static_cast<int>(m_always.size()); }
+
+    // candidates[i] != 0 表示第 i 条规则需要执行正则
+    void scan(const char *p, std::size_t n, std::vector<char> &candidates) const;
+
+    // 提取正则中顶层必须出现的最长字面量（UTF-8），取不到时返回空串
+    static std::string requiredLiteral(const std::string &pattern);
+
+private:
+    struct Node {
+        std::array<int, 256> next;
+        int fail = 0;
+        std::vector<int> out; // 到达该状态时命中的规则（已合并失败链）
+        Node() { next.fill(-1); }
+    };
+
+    std::vector<Node> m_nodes{Node()};
+    std::vector<char> m_always;
+    bool m_hasLiterals = false;
+};
+
+#endif // PATTERNPREFILTER_H
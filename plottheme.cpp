@@ -0,0 +1,38 @@
+#include "plottheme.h"
+
+#include "qcustomplot/qcustomplot.h"
+
+PlotPalette plotPalette(bool dark)
+{
+    PlotPalette p;
+    p.background = dark ? QColor(24, 24, 24) : QColor(255, 255, 255);
+    p.axis = dark ? QColor(230, 230, 230) : QColor(30, 30, 30);
+    p.grid = dark ? QColor(80, 80, 80) : QColor(180, 180, 180);
+    return p;
+}
+
+void applyPlotTheme(QCustomPlot *plot, bool dark)
+{
+    if (!plot) return;
+    const PlotPalette p = plotPalette(dark);
+    plot->setBackground(p.background);
+    if (auto rect = plot->axisRect()) rect->setBackground(p.background);
+    auto applyAxis = [&](QCPAxis* ax) {
+        if (!ax) return;
+        ax->setBasePen(QPen(p.axis));
+        ax->setTickPen(QPen(p.axis));
+        ax->setSubTickPen(QPen(p.axis));
+        ax->setLabelColor(p.axis);
+        ax->setTickLabelColor(p.axis);
+        if (ax->grid()) {
+            ax->grid()->setPen(QPen(p.grid));
+            ax->grid()->setSubGridPen(QPen(p.grid.lighter()));
+        }
+    };
+    applyAxis(plot->xAxis);
+    applyAxis(plot->yAxis);
+    applyAxis(plot->xAxis2);
+    applyAxis(plot->yAxis2);
+    if (plot->xAxis2->grid()) plot->xAxis2->grid()->setVisible(false);
+    if (plot->yAxis2->grid()) plot->yAxis2->grid()->setVisible(false);
+}
@@ -0,0 +1,20 @@
+#ifndef PLOTTHEME_H
+#define PLOTTHEME_H
+
+#include <QColor>
+
+class QCustomPlot;
+
+// 各绘图视图共用的深浅色主题：背景、坐标轴文字与网格
+struct PlotPalette {
+    QColor background;
+    QColor axis;
+    QColor grid;
+};
+
+PlotPalette plotPalette(bool dark);
+
+// 设置背景和四条坐标轴的颜色；右轴与上轴不画网格，避免与左轴、下轴的网格重叠
+void applyPlotTheme(QCustomPlot *plot, bool dark);
+
+#endif // PLOTTHEME_H
@@ -0,0 +1,122 @@
+#include "renderscheduler.h"
+
+#include <QEvent>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+#include "qcustomplot/qcustomplot.h"
+
+RenderScheduler::RenderScheduler(QObject *parent)
+    : QObject(parent)
+{
+    // Widgets 拿不到垂直同步回调，用精确定时器按主屏刷新率近似
+    if (QScreen *screen = QGuiApplication::primaryScreen()) {
+        const qreal rate = screen->refreshRate();
+        if (rate > 1.0) m_intervalMs = std::max(1, static_cast<int>(std::lround(1000.0 / rate)));
+    }
+    m_frameTimer = new QTimer(this);
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    m_frameTimer->setInterval(m_intervalMs);
+    connect(m_frameTimer, &QTimer::timeout, this, &RenderScheduler::frame);
+
+    m_statsTimer = new QTimer(this);
+    m_statsTimer->setInterval(1000);
+    connect(m_statsTimer, &QTimer::timeout, this, &RenderScheduler::publishStats);
+    m_statsTimer->start();
+    m_clock.start();
+}
+
+void RenderScheduler::addPlot(QCustomPlot *plot, std::function<bool()> prepare)
+{
+    if (!plot) return;
+    Target target;
+    target.plot = plot;
+    target.prepare = std::move(prepare);
+    m_targets.push_back(std::move(target));
+    // 图重新显示、窗口从最小化恢复时补画积压的内容
+    plot->installEventFilter(this);
+    if (QWidget *window = plot->window(); window && window != plot) window->installEventFilter(this);
+}
+
+void RenderScheduler::markDirty(QCustomPlot *plot)
+{
+    for (Target &t : m_targets) {
+        if (t.plot == plot) {
+            t.dirty = true;
+            break;
+        }
+    }
+    wake();
+}
+
+bool RenderScheduler::isShown(const QCustomPlot *plot)
+{
+    return plot && plot->isVisible() && !plot->window()->isMinimized();
+}
+
+bool RenderScheduler::hasPendingWork() const
+{
+    return std::any_of(m_targets.begin(), m_targets.end(), [](const Target &t) { return t.dirty && isShown(t.plot); });
+}
+
+void RenderScheduler::wake()
+{
+    if (!m_frameTimer->isActive() && hasPendingWork()) m_frameTimer->start();
+}
+
+bool RenderScheduler::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Show || event->type() == QEvent::WindowStateChange) {
+        // 事件处理时可见性尚未更新完，排到事件循环之后再检查
+        QTimer::singleShot(0, this, &RenderScheduler::wake);
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void RenderScheduler::frame()
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    if (m_lastFrameNs >= 0) {
+        // 两次触发之间每多隔一个刷新周期就算丢一帧（重绘太慢或事件循环被占用）
+        const double gap = static_cast<double>(now - m_lastFrameNs) / 1e6;
+        const int missed = static_cast<int>(std::lround(gap / m_intervalMs)) - 1;
+        if (missed > 0) m_dropped += missed;
+    }
+    m_lastFrameNs = now;
+
+    bool rendered = false;
+    for (Target &t : m_targets) {
+        if (!t.dirty || !isShown(t.plot)) continue;
+        t.dirty = false;
+        if (t.prepare && !t.prepare()) continue;
+        // 同步重绘到图层缓冲，窗口刷新时只贴图
+        t.plot->replot(QCustomPlot::rpRefreshHint);
+        rendered = true;
+    }
+    if (rendered) {
+        const double ms = static_cast<double>(m_clock.nsecsElapsed() - now) / 1e6;
+        ++m_frames;
+        m_totalMs += ms;
+        m_maxMs = std::max(m_maxMs, ms);
+    }
+    if (!hasPendingWork()) {
+        m_frameTimer->stop();
+        m_lastFrameNs = -1;
+    }
+}
+
+void RenderScheduler::publishStats()
+{
+    FrameStats stats;
+    stats.frames = m_frames;
+    stats.averageMs = m_frames > 0 ? m_totalMs / m_frames : 0.0;
+    stats.maxMs = m_maxMs;
+    stats.dropped = m_dropped;
+    m_frames = 0;
+    m_totalMs = 0.0;
+    m_maxMs = 0.0;
+    m_dropped = 0;
+    emit statsUpdated(stats);
+}
@@ -0,0 +1,70 @@
+#ifndef RENDERSCHEDULER_H
+#define RENDERSCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <functional>
+#include <vector>
+
+class QCustomPlot;
+class QTimer;
+
+// 各绘图视图共用的重绘调度：数据到达时只把图标脏，按显示器刷新周期统一重绘，
+// 每个周期每张图至多重绘一次，且只重绘脏的、当前可见的图（所在页签被切走或窗口最小化时不画，
+// 重新显示后补画一次）。没有脏图时定时器停止，空闲时没有任何开销。
+// 同时统计每帧耗时与丢帧数（两次重绘之间错过的刷新周期），每秒通过 statsUpdated 报告一次。
+class RenderScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    struct FrameStats {
+        int frames = 0;         // 本统计周期内的重绘帧数
+        double averageMs = 0.0; // 每帧准备数据与重绘的平均耗时
+        double maxMs = 0.0;
+        int dropped = 0;        // 有待画内容时错过的刷新周期数
+    };
+
+    explicit RenderScheduler(QObject *parent = nullptr);
+
+    int frameIntervalMs() const { return m_intervalMs; }
+
+    // prepare 在该图每次重绘前于 GUI 线程调用，可在其中整理数据、调整坐标轴；返回 false 表示无需重绘
+    void addPlot(QCustomPlot *plot, std::function<bool()> prepare = {});
+    void markDirty(QCustomPlot *plot);
+
+signals:
+    void statsUpdated(const RenderScheduler::FrameStats &stats);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void frame();
+    void publishStats();
+
+private:
+    struct Target {
+        QPointer<QCustomPlot> plot;
+        std::function<bool()> prepare;
+        bool dirty = false;
+    };
+
+    static bool isShown(const QCustomPlot *plot);
+    bool hasPendingWork() const;
+    void wake();
+
+    std::vector<Target> m_targets;
+    QTimer* m_frameTimer = nullptr;
+    QTimer* m_statsTimer = nullptr;
+    int m_intervalMs = 16;
+
+    QElapsedTimer m_clock;
+    qint64 m_lastFrameNs = -1; // 上一帧的时刻，定时器停止后置 -1，空闲间隔不计入丢帧
+    int m_frames = 0;
+    double m_totalMs = 0.0;
+    double m_maxMs = 0.0;
+    int m_dropped = 0;
+};
+
+#endif // RENDERSCHEDULER_H
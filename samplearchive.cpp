@@ -0,0 +1,255 @@
+#include "samplearchive.h"
+
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+SampleArchive::SampleArchive(const QString &path)
+    : m_file(path)
+{
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+        m_failed = true;
+        m_error = m_file.errorString();
+    }
+    m_pendingKeys.reserve(kBlockSamples);
+    m_pendingValues.reserve(kBlockSamples);
+}
+
+SampleArchive::~SampleArchive()
+{
+    unmapAll();
+    m_file.close();
+}
+
+void SampleArchive::unmapAll()
+{
+    for (const Mapping &m : m_mapped) m_file.unmap(m.data);
+    m_mapped.clear();
+}
+
+void SampleArchive::append(const double *keys, const double *values, int count)
+{
+    while (count > 0) {
+        const int take = std::min(count, kBlockSamples - static_cast<int>(m_pendingKeys.size()));
+        m_pendingKeys.insert(m_pendingKeys.end(), keys, keys + take);
+        m_pendingValues.insert(m_pendingValues.end(), values, values + take);
+        keys += take;
+        values += take;
+        count -= take;
+        if (static_cast<int>(m_pendingKeys.size()) == kBlockSamples) flushBlock();
+    }
+}
+
+void SampleArchive::clear()
+{
+    unmapAll();
+    if (m_file.isOpen()) m_failed = !m_file.resize(0);
+    m_error = m_failed ? m_file.errorString() : QString();
+    m_summaries.clear();
+    m_pendingKeys.clear();
+    m_pendingValues.clear();
+}
+
+uchar *SampleArchive::segment(int index)
+{
+    for (Mapping &m : m_mapped) {
+        if (m.segment == index) {
+            m.lastUse = ++m_useTick;
+            return m.data;
+        }
+    }
+    if (static_cast<int>(m_mapped.size()) >= kMaxMapped) {
+        auto oldest = std::min_element(m_mapped.begin(), m_mapped.end(),
+                                       [](const Mapping &a, const Mapping &b) { return a.lastUse < b.lastUse; });
+        m_file.unmap(oldest->data);
+        m_mapped.erase(oldest);
+    }
+    uchar *data = m_file.map(qint64(index) * kSegmentBytes, kSegmentBytes);
+    if (!data) return nullptr;
+    m_mapped.push_back(Mapping{index, data, ++m_useTick});
+    return data;
+}
+
+void SampleArchive::flushBlock()
+{
+    const std::vector<double> &keys = m_pendingKeys;
+    const std::vector<double> &values = m_pendingValues;
+    const int index = blockCount();
+    const int seg = index / kBlocksPerSegment;
+
+    // 按段预先扩展文件（一次多扩几段），段内各块直接写入映射内存。
+    // Windows 上文件有映射视图时不能改变大小，而且映射对象的大小在首次映射时就固定了，
+    // 所以扩展前先解除全部映射，之后按需重新映射
+    uchar *base = nullptr;
+    if (!m_failed) {
+        const qint64 needed = qint64(seg + 1) * kSegmentBytes;
+        if (m_file.size() < needed) {
+            unmapAll();
+            const qint64 grown = (qint64(seg / kGrowSegments) + 1) * kGrowSegments * kSegmentBytes;
+            if (!m_file.resize(grown)) {
+                m_failed = true;
+                m_error = m_file.errorString();
+            }
+        }
+        if (!m_failed) {
+            base = segment(seg);
+            if (!base) {
+                m_failed = true;
+                m_error = m_file.errorString();
+            }
+        }
+    }
+    if (m_failed) {
+        // 落盘失败：丢弃这一块，不再记录摘要，避免摘要与文件内容不符
+        m_pendingKeys.clear();
+        m_pendingValues.clear();
+        return;
+    }
+
+    double *col = reinterpret_cast<double *>(base + qint64(index % kBlocksPerSegment) * kBlockBytes);
+    double *keyCol = col;
+    double *valueCol = col + kBlockSamples;
+    double *subMin = valueCol + kBlockSamples;
+    double *subMax = subMin + kSubBuckets;
+    std::memcpy(keyCol, keys.data(), sizeof(double) * kBlockSamples);
+    std::memcpy(valueCol, values.data(), sizeof(double) * kBlockSamples);
+
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    BlockSummary s;
+    s.firstKey = keys.front();
+    s.lastKey = keys.back();
+    s.firstValue = values.front();
+    s.lastValue = values.back();
+    s.min = inf;
+    s.max = -inf;
+    for (int b = 0; b < kSubBuckets; ++b) {
+        double mn = inf;
+        double mx = -inf;
+        for (int i = b * kSubSamples; i < (b + 1) * kSubSamples; ++i) {
+            const double v = values[static_cast<std::size_t>(i)];
+            if (std::isnan(v)) continue;
+            mn = std::min(mn, v);
+            mx = std::max(mx, v);
+            s.sum += v;
+            ++s.valid;
+        }
+        subMin[b] = mn;
+        subMax[b] = mx;
+        s.min = std::min(s.min, mn);
+        s.max = std::max(s.max, mx);
+    }
+    m_summaries.push_back(s);
+    m_pendingKeys.clear();
+    m_pendingValues.clear();
+}
+
+double SampleArchive::firstKey() const
+{
+    if (!m_summaries.empty()) return m_summaries.front().firstKey;
+    return m_pendingKeys.empty() ? 0.0 : m_pendingKeys.front();
+}
+
+int SampleArchive::findBlock(double key) const
+{
+    const auto it = std::lower_bound(m_summaries.begin(), m_summaries.end(), key,
+                                     [](const BlockSummary &s, double k) { return s.lastKey < k; });
+    return static_cast<int>(it - m_summaries.begin());
+}
+
+bool SampleArchive::block(int index, BlockView &out)
+{
+    if (index < 0 || index >= blockCount()) return false;
+    uchar *base = segment(index / kBlocksPerSegment);
+    if (!base) return false;
+    const double *col = reinterpret_cast<const double *>(base + qint64(index % kBlocksPerSegment) * kBlockBytes);
+    out.keys = col;
+    out.values = col + kBlockSamples;
+    out.subMin = out.values + kBlockSamples;
+    out.subMax = out.subMin + kSubBuckets;
+    return true;
+}
+
+SampleArchive::Stats SampleArchive::stats() const
+{
+    Stats st;
+    if (isEmpty()) return st;
+    double sum = 0.0;
+    bool any = false;
+    auto take = [&](double mn, double mx) {
+        st.min = any ? std::min(st.min, mn) : mn;
+        st.max = any ? std::max(st.max, mx) : mx;
+        any = true;
+    };
+    for (const BlockSummary &s : m_summaries) {
+        if (s.valid == 0) continue;
+        take(s.min, s.max);
+        sum += s.sum;
+        st.count += static_cast<quint64>(s.valid);
+    }
+    for (double v : m_pendingValues) {
+        if (std::isnan(v)) continue;
+        take(v, v);
+        sum += v;
+        ++st.count;
+    }
+    st.mean = st.count ? sum / static_cast<double>(st.count) : 0.0;
+    st.firstKey = firstKey();
+    st.lastKey = m_pendingKeys.empty() ? m_summaries.back().lastKey : m_pendingKeys.back();
+    return st;
+}
+
+SampleArchive::ExportSource SampleArchive::exportSource(const QString &name) const
+{
+    ExportSource src;
+    src.name = name;
+    src.path = m_file.fileName();
+    src.blocks = blockCount();
+    src.tailKeys = QVector<double>(m_pendingKeys.begin(), m_pendingKeys.end());
+    src.tailValues = QVector<double>(m_pendingValues.begin(), m_pendingValues.end());
+    return src;
+}
+
+bool SampleArchive::exportCsv(const QVector<ExportSource> &sources, const QString &path, QString *error)
+{
+    QFile out(path);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        if (error) *error = out.errorString();
+        return false;
+    }
+    QTextStream ts(&out);
+    ts << "channel,key,value\n";
+
+    // 已落盘的块内容不再改变，另开只读句柄按块顺序读取键列和值列
+    std::vector<double> buf(static_cast<std::size_t>(2 * kBlockSamples));
+    for (const ExportSource &src : sources) {
+        QFile in(src.path);
+        if (src.blocks > 0 && !in.open(QIODevice::ReadOnly)) {
+            if (error) *error = in.errorString();
+            return false;
+        }
+        const qint64 columnBytes = qint64(2 * kBlockSamples) * qint64(sizeof(double));
+        for (int b = 0; b < src.blocks; ++b) {
+            if (!in.seek(qint64(b) * kBlockBytes)
+                || in.read(reinterpret_cast<char *>(buf.data()), columnBytes) != columnBytes) {
+                if (error) *error = in.errorString();
+                return false;
+            }
+            for (int i = 0; i < kBlockSamples; ++i) {
+                ts << src.name << ',' << QString::number(buf[static_cast<std::size_t>(i)], 'g', 15) << ','
+                   << QString::number(buf[static_cast<std::size_t>(kBlockSamples + i)], 'g', 10) << '\n';
+            }
+        }
+        for (int i = 0; i < src.tailKeys.size(); ++i) {
+            ts << src.name << ',' << QString::number(src.tailKeys.at(i), 'g', 15) << ','
+               << QString::number(src.tailValues.at(i), 'g', 10) << '\n';
+        }
+    }
+    ts.flush();
+    if (ts.status() != QTextStream::Ok) {
+        if (error) *error = out.errorString();
+        return false;
+    }
+    return true;
+}
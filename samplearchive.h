@@ -0,0 +1,113 @@
+#ifndef SAMPLEARCHIVE_H
+#define SAMPLEARCHIVE_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <vector>
+
+// 波形历史的磁盘列式存储：每个通道一个文件，按固定大小的块顺序写入。
+// 块内依次为键列、值列、子桶最小值列、子桶最大值列，文件按段内存映射，按需页入；
+// 每块的摘要（首末键、首末值、最小/最大值、和）常驻内存，缩得很小时只用摘要绘制，
+// 统计也只遍历摘要。未写满一块的尾部样本暂存在内存中。
+// 只在创建它的线程上使用；导出在后台线程上另开文件句柄顺序读取，不经过映射。
+class SampleArchive
+{
+public:
+    static constexpr int kBlockSamples = 4096;
+    static constexpr int kSubSamples = 64; // 每个子桶的样本数
+    static constexpr int kSubBuckets = kBlockSamples / kSubSamples;
+
+    struct BlockSummary {
+        double firstKey = 0.0;
+        double lastKey = 0.0;
+        double firstValue = 0.0;
+        double lastValue = 0.0;
+        double min = 0.0; // 全为 NaN 时 min > max
+        double max = 0.0;
+        double sum = 0.0; // 非 NaN 样本之和与个数，供统计
+        int valid = 0;
+    };
+
+    // 块的列视图，指针在下一次调用 block() 之前有效
+    struct BlockView {
+        const double *keys = nullptr;
+        const double *values = nullptr;
+        const double *subMin = nullptr;
+        const double *subMax = nullptr;
+    };
+
+    struct Stats {
+        quint64 count = 0; // 非 NaN 样本数
+        double min = 0.0;
+        double max = 0.0;
+        double mean = 0.0;
+        double firstKey = 0.0;
+        double lastKey = 0.0;
+    };
+
+    // 导出所需的全部信息，可复制到后台线程
+    struct ExportSource {
+        QString name;
+        QString path;
+        int blocks = 0;
+        QVector<double> tailKeys;
+        QVector<double> tailValues;
+    };
+
+    explicit SampleArchive(const QString &path);
+    ~SampleArchive();
+
+    bool isOpen() const { return m_file.isOpen() && !m_failed; }
+    bool hasFailed() const { return m_failed; } // 写入失败后只保留失败前已落盘的块
+    QString errorString() const { return m_error; }
+
+    // 写满一块时落盘；写入失败后停止落盘，已写入的部分仍可读取
+    void append(const double *keys, const double *values, int count);
+    void clear();
+
+    bool isEmpty() const { return m_summaries.empty() && m_pendingKeys.empty(); }
+    double firstKey() const;
+
+    int blockCount() const { return static_cast<int>(m_summaries.size()); }
+    int tailCount() const { return static_cast<int>(m_pendingKeys.size()); } // 尚未写满一块、只在内存中的样本
+    const double *tailKeys() const { return m_pendingKeys.data(); }
+    const double *tailValues() const { return m_pendingValues.data(); }
+    const BlockSummary &summary(int index) const { return m_summaries[static_cast<std::size_t>(index)]; }
+    int findBlock(double key) const; // 第一个 lastKey >= key 的块，没有时返回 blockCount()
+    bool block(int index, BlockView &out);
+
+    Stats stats() const;
+    ExportSource exportSource(const QString &name) const;
+
+    // 在任意线程上把若干通道写成 CSV（通道,键,值），出错时返回 false 并给出原因
+    static bool exportCsv(const QVector<ExportSource> &sources, const QString &path, QString *error);
+
+private:
+    static constexpr int kBlocksPerSegment = 64;
+    static constexpr qint64 kBlockBytes = qint64(2 * kBlockSamples + 2 * kSubBuckets) * qint64(sizeof(double));
+    static constexpr qint64 kSegmentBytes = kBlockBytes * kBlocksPerSegment;
+    static constexpr int kMaxMapped = 16; // 同时映射的段数上限，超出时解除最久未用的
+    static constexpr int kGrowSegments = 8; // 文件每次扩展的段数，减少扩展（及随之的解除映射）次数
+
+    struct Mapping {
+        int segment = -1;
+        uchar *data = nullptr;
+        quint64 lastUse = 0;
+    };
+
+    uchar *segment(int index);
+    void flushBlock();
+    void unmapAll();
+
+    QFile m_file;
+    bool m_failed = false;
+    QString m_error;
+    std::vector<BlockSummary> m_summaries;
+    std::vector<double> m_pendingKeys;
+    std::vector<double> m_pendingValues;
+    std::vector<Mapping> m_mapped;
+    quint64 m_useTick = 0;
+};
+
+#endif // SAMPLEARCHIVE_H
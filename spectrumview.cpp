@@ -0,0 +1,297 @@
+#include "spectrumview.h"
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QMouseEvent>
+#include <QPushButton>
+#include <QSignalBlocker>
+#include <QSpinBox>
+#include <QSplitter>
+#include <QVBoxLayout>
+#include <algorithm>
+#include <cmath>
+#include "channelregistry.h"
+#include "plottheme.h"
+#include "renderscheduler.h"
+#include "spectrumworker.h"
+#include "waterfallmap.h"
+
+SpectrumView::SpectrumView(QWidget *parent)
+    : QWidget(parent)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    QHBoxLayout *controls = new QHBoxLayout;
+    controls->setContentsMargins(4, 4, 4, 0);
+    m_channelBox = new QComboBox(this);
+    m_channelBox->setMinimumWidth(120);
+    m_sizeBox = new QComboBox(this);
+    for (int n = SpectrumWorker::kMinSize; n <= SpectrumWorker::kMaxSize; n *= 2) m_sizeBox->addItem(QString::number(n), n);
+    m_sizeBox->setCurrentIndex(m_sizeBox->findData(4096));
+    m_windowBox = new QComboBox(this);
+    m_windowBox->addItem(QStringLiteral("Hann"), SpectrumWorker::Hann);
+    m_windowBox->addItem(QStringLiteral("Blackman"), SpectrumWorker::Blackman);
+    m_averageBox = new QSpinBox(this);
+    m_averageBox->setRange(1, 64);
+    m_averageBox->setToolTip(QString::fromUtf8(u8"平均帧数，1 为不平均"));
+    m_peakBox = new QCheckBox(QString::fromUtf8(u8"峰值保持"), this);
+    QPushButton *resetPeak = new QPushButton(QString::fromUtf8(u8"清除峰值"), this);
+    m_logBox = new QCheckBox(QString::fromUtf8(u8"对数频率"), this);
+    controls->addWidget(new QLabel(QString::fromUtf8(u8"通道"), this));
+    controls->addWidget(m_channelBox);
+    controls->addWidget(new QLabel(QString::fromUtf8(u8"点数"), this));
+    controls->addWidget(m_sizeBox);
+    controls->addWidget(new QLabel(QString::fromUtf8(u8"窗"), this));
+    controls->addWidget(m_windowBox);
+    controls->addWidget(new QLabel(QString::fromUtf8(u8"平均"), this));
+    controls->addWidget(m_averageBox);
+    controls->addWidget(m_peakBox);
+    controls->addWidget(resetPeak);
+    controls->addWidget(m_logBox);
+    controls->addStretch(1);
+    layout->addLayout(controls);
+
+    QSplitter *splitter = new QSplitter(Qt::Vertical, this);
+    m_plot = new QCustomPlot(splitter);
+    m_plot->xAxis->setLabel(QString::fromUtf8(u8"频率 (Hz)"));
+    m_plot->yAxis->setLabel(QString::fromUtf8(u8"幅值 (dB)"));
+    m_plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    m_peakGraph = m_plot->addGraph();
+    m_peakGraph->setPen(QPen(QColor(255, 152, 0), 1, Qt::DashLine));
+    m_graph = m_plot->addGraph();
+    m_graph->setPen(QPen(QColor(33, 150, 243)));
+    m_plot->installEventFilter(this);
+    connect(m_plot, &QCustomPlot::mouseDoubleClick, this, [this]() {
+        m_autoRange = true;
+        m_dirty = true;
+        requestFrame();
+    });
+
+    // 瀑布图：纵轴为帧龄，最新一帧在最上方
+    m_waterfallPlot = new QCustomPlot(splitter);
+    m_waterfallPlot->yAxis->setLabel(QString::fromUtf8(u8"帧（新→旧）"));
+    m_waterfallPlot->yAxis->setRangeReversed(true);
+    m_waterfallPlot->yAxis->setRange(0, kWaterfallRows);
+    m_waterfall = new WaterfallMap(m_waterfallPlot->xAxis, m_waterfallPlot->yAxis, kWaterfallRows, kWaterfallColumns);
+    m_colorScale = new QCPColorScale(m_waterfallPlot);
+    m_colorScale->setLabel(QStringLiteral("dB"));
+    m_colorScale->setGradient(QCPColorGradient::gpJet);
+    m_colorScale->setDataRange(m_waterfall->dataRange());
+    m_colorScale->setRangeDrag(true);
+    m_colorScale->setRangeZoom(true);
+    m_waterfallPlot->plotLayout()->addElement(0, 1, m_colorScale);
+    // 只允许在色标上拖动/缩放色阶，图本身的横轴跟随频谱
+    m_waterfallPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    m_waterfallPlot->axisRect()->setRangeDrag(Qt::Orientations());
+    m_waterfallPlot->axisRect()->setRangeZoom(Qt::Orientations());
+    QCPMarginGroup *margins = new QCPMarginGroup(m_waterfallPlot);
+    m_waterfallPlot->axisRect()->setMarginGroup(QCP::msLeft | QCP::msRight, margins);
+    m_colorScale->setMarginGroup(QCP::msTop | QCP::msBottom, margins);
+    connect(m_colorScale, &QCPColorScale::dataRangeChanged, this, [this](const QCPRange &range) {
+        m_waterfall->setDataRange(range);
+        m_waterfallDirty = true;
+        requestFrame();
+    });
+    connect(m_plot->xAxis, qOverload<const QCPRange &>(&QCPAxis::rangeChanged), this, [this](const QCPRange &range) {
+        m_waterfallPlot->xAxis->setRange(range);
+        m_waterfallDirty = true;
+        requestFrame();
+    });
+    connect(m_waterfallPlot, &QCustomPlot::mouseDoubleClick, this, [this]() { m_waterfallAutoRange = true; });
+
+    splitter->addWidget(m_plot);
+    splitter->addWidget(m_waterfallPlot);
+    splitter->setStretchFactor(0, 1);
+    splitter->setStretchFactor(1, 1);
+    layout->addWidget(splitter, 1);
+
+    connect(m_channelBox, &QComboBox::currentIndexChanged, this, &SpectrumView::emitSettings);
+    connect(m_sizeBox, &QComboBox::currentIndexChanged, this, &SpectrumView::emitSettings);
+    connect(m_windowBox, &QComboBox::currentIndexChanged, this, &SpectrumView::emitSettings);
+    connect(m_averageBox, &QSpinBox::valueChanged, this, &SpectrumView::emitSettings);
+    connect(m_peakBox, &QCheckBox::toggled, this, &SpectrumView::emitSettings);
+    connect(resetPeak, &QPushButton::clicked, this, &SpectrumView::peakResetRequested);
+    connect(m_logBox, &QCheckBox::toggled, this, &SpectrumView::setLogFrequency);
+}
+
+void SpectrumView::setRegistry(ChannelRegistry *registry)
+{
+    m_registry = registry;
+    if (!m_registry) return;
+    connect(m_registry, &ChannelRegistry::channelAdded, this, &SpectrumView::syncChannels, Qt::QueuedConnection);
+    syncChannels();
+}
+
+void SpectrumView::setScheduler(RenderScheduler *scheduler)
+{
+    m_scheduler = scheduler;
+    if (!m_scheduler) return;
+    m_scheduler->addPlot(m_plot, [this]() { return prepareFrame(); });
+    m_scheduler->addPlot(m_waterfallPlot, [this]() {
+        const bool dirty = m_waterfallDirty;
+        m_waterfallDirty = false;
+        return dirty;
+    });
+}
+
+void SpectrumView::applyTheme(bool dark)
+{
+    applyPlotTheme(m_plot, dark);
+    applyPlotTheme(m_waterfallPlot, dark);
+    const PlotPalette p = plotPalette(dark);
+    QCPAxis *scaleAxis = m_colorScale->axis();
+    scaleAxis->setBasePen(QPen(p.axis));
+    scaleAxis->setTickPen(QPen(p.axis));
+    scaleAxis->setSubTickPen(QPen(p.axis));
+    scaleAxis->setLabelColor(p.axis);
+    scaleAxis->setTickLabelColor(p.axis);
+    m_dirty = true;
+    m_waterfallDirty = true;
+    requestFrame();
+}
+
+void SpectrumView::syncChannels()
+{
+    if (!m_registry) return;
+    const QStringList names = m_registry->channelNames();
+    const bool wasEmpty = m_channelBox->count() == 0;
+    {
+        QSignalBlocker blocker(m_channelBox);
+        for (int id = m_channelBox->count(); id < names.size(); ++id) m_channelBox->addItem(names.at(id), id);
+    }
+    // 第一个通道出现时自动选中并开始计算
+    if (wasEmpty && m_channelBox->count() > 0) emitSettings();
+}
+
+void SpectrumView::emitSettings()
+{
+    const int channel = m_channelBox->count() > 0 ? m_channelBox->currentData().toInt() : -1;
+    m_autoRange = true;
+    // 换了通道或参数，旧的瀑布历史不再可比
+    m_waterfall->clear();
+    m_waterfallAutoRange = true;
+    m_waterfallDirty = true;
+    emit settingsChanged(channel, m_sizeBox->currentData().toInt(), m_windowBox->currentData().toInt(),
+                         m_averageBox->value(), m_peakBox->isChecked());
+}
+
+void SpectrumView::setLogFrequency(bool on)
+{
+    // 对数轴上不能画直流频点，准备数据时从第一个频点开始
+    for (QCPAxis *axis : {m_plot->xAxis, m_waterfallPlot->xAxis}) {
+        axis->setScaleType(on ? QCPAxis::stLogarithmic : QCPAxis::stLinear);
+        if (on) axis->setTicker(QSharedPointer<QCPAxisTickerLog>(new QCPAxisTickerLog));
+        else axis->setTicker(QSharedPointer<QCPAxisTicker>(new QCPAxisTicker));
+    }
+    m_autoRange = true;
+    m_dirty = true;
+    requestFrame();
+}
+
+void SpectrumView::setSpectrum(const QVector<double> &powerDb, const QVector<double> &peakDb, double sampleRate)
+{
+    // 只保存，转换成曲线数据留到重绘前，工作线程发得再快每帧也只转换一次
+    m_powerDb = powerDb;
+    m_peakDb = peakDb;
+    m_sampleRate = sampleRate;
+    m_dirty = true;
+    if (m_powerDb.size() >= 2) {
+        const int size = static_cast<int>(m_powerDb.size() - 1) * 2;
+        addWaterfallRow((sampleRate > 0 ? sampleRate : 1.0) / size);
+    }
+    requestFrame();
+}
+
+void SpectrumView::addWaterfallRow(double binHz)
+{
+    // 每帧结果只着色这一行，旧行原样保留
+    const int bins = static_cast<int>(m_powerDb.size());
+    const int oldRows = m_waterfall->filledRows();
+    m_waterfall->setLayout(bins, m_logBox->isChecked(), binHz);
+    if (m_waterfall->filledRows() < oldRows) m_waterfallAutoRange = true; // 点数、刻度或分辨率变了，历史已清空
+    if (m_waterfallAutoRange) {
+        double lo = 0.0;
+        double hi = 0.0;
+        bool found = false;
+        for (double v : m_powerDb) {
+            if (std::isnan(v)) continue;
+            lo = found ? std::min(lo, v) : v;
+            hi = found ? std::max(hi, v) : v;
+            found = true;
+        }
+        if (found && hi > lo) {
+            m_waterfallAutoRange = false;
+            // 设置色标会经 dataRangeChanged 同步到瀑布图
+            m_colorScale->setDataRange(QCPRange(std::max(lo, hi - 120.0), hi));
+        }
+    }
+    m_waterfall->addRow(m_powerDb.constData(), bins);
+    m_waterfallDirty = true;
+}
+
+void SpectrumView::requestFrame()
+{
+    if (m_scheduler) {
+        if (m_dirty) m_scheduler->markDirty(m_plot);
+        if (m_waterfallDirty) m_scheduler->markDirty(m_waterfallPlot);
+        return;
+    }
+    if (prepareFrame()) m_plot->replot(QCustomPlot::rpQueuedReplot);
+    if (m_waterfallDirty) {
+        m_waterfallDirty = false;
+        m_waterfallPlot->replot(QCustomPlot::rpQueuedReplot);
+    }
+}
+
+void SpectrumView::fillGraph(QCPGraph *graph, const QVector<double> &db, double binHz)
+{
+    const int first = m_logBox->isChecked() ? 1 : 0;
+    m_points.resize(std::max<qsizetype>(0, db.size() - first));
+    for (int i = first; i < db.size(); ++i) {
+        QCPGraphData &p = m_points[i - first];
+        p.key = i * binHz;
+        p.value = db.at(i);
+    }
+    graph->data()->set(m_points, true);
+}
+
+bool SpectrumView::prepareFrame()
+{
+    if (!m_dirty) return false;
+    m_dirty = false;
+    if (m_powerDb.size() < 2) return true;
+
+    // 估计不出采样率时横轴为归一化频率（周期/样本）
+    const int size = static_cast<int>(m_powerDb.size() - 1) * 2;
+    const bool haveRate = m_sampleRate > 0;
+    const double binHz = (haveRate ? m_sampleRate : 1.0) / size;
+    fillGraph(m_graph, m_powerDb, binHz);
+    fillGraph(m_peakGraph, m_peakDb, binHz);
+
+    if (binHz != m_shownBinHz) {
+        m_shownBinHz = binHz;
+        m_plot->xAxis->setLabel(haveRate ? QString::fromUtf8(u8"频率 (Hz)") : QString::fromUtf8(u8"归一化频率 (周期/样本)"));
+    }
+    if (m_autoRange) {
+        const double nyquist = binHz * (m_powerDb.size() - 1);
+        m_plot->xAxis->setRange(m_logBox->isChecked() ? binHz : 0.0, nyquist);
+        m_graph->rescaleValueAxis(false, true);
+        if (!m_peakDb.isEmpty()) m_peakGraph->rescaleValueAxis(true, true);
+        m_plot->yAxis->scaleRange(1.1, m_plot->yAxis->range().center());
+    }
+    return true;
+}
+
+bool SpectrumView::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_plot && event->type() == QEvent::MouseButtonPress) {
+        // 拖动或缩放后不再自动缩放，双击恢复
+        if (static_cast<QMouseEvent*>(event)->button() == Qt::LeftButton) m_autoRange = false;
+    } else if (watched == m_plot && event->type() == QEvent::Wheel) {
+        m_autoRange = false;
+    }
+    return QWidget::eventFilter(watched, event);
+}
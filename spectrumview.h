@@ -0,0 +1,80 @@
+#ifndef SPECTRUMVIEW_H
+#define SPECTRUMVIEW_H
+
+#include <QVector>
+#include <QWidget>
+#include "qcustomplot/qcustomplot.h"
+
+class ChannelRegistry;
+class QCheckBox;
+class QComboBox;
+class QSpinBox;
+class RenderScheduler;
+class WaterfallMap;
+
+// 频谱视图：选择通道、FFT 点数、窗函数、平均帧数与峰值保持，计算在 SpectrumWorker 线程中进行。
+// 新结果只保存并标脏，由 RenderScheduler 每帧至多转换、重绘一次；频率轴可切换为对数。
+// 下方的瀑布图每收到一帧结果就着色一行，横轴与频谱同步，拖动色标可调整色阶。
+class SpectrumView : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit SpectrumView(QWidget *parent = nullptr);
+
+    void setRegistry(ChannelRegistry *registry);
+    void setScheduler(RenderScheduler *scheduler);
+    void applyTheme(bool dark);
+
+    static constexpr int kWaterfallRows = 512;     // 瀑布图保留的帧数
+    static constexpr int kWaterfallColumns = 1024; // 每行重采样到的列数上限
+
+public slots:
+    void setSpectrum(const QVector<double> &powerDb, const QVector<double> &peakDb, double sampleRate);
+
+signals:
+    // 参数含义同 SpectrumWorker::configure
+    void settingsChanged(int channel, int size, int window, int averages, bool peakHold);
+    void peakResetRequested();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void syncChannels();
+    void emitSettings();
+    void setLogFrequency(bool on);
+
+private:
+    void requestFrame();
+    bool prepareFrame();
+    void addWaterfallRow(double binHz);
+    void fillGraph(QCPGraph *graph, const QVector<double> &db, double binHz);
+
+    ChannelRegistry* m_registry = nullptr;
+    RenderScheduler* m_scheduler = nullptr;
+    QComboBox* m_channelBox = nullptr;
+    QComboBox* m_sizeBox = nullptr;
+    QComboBox* m_windowBox = nullptr;
+    QSpinBox* m_averageBox = nullptr;
+    QCheckBox* m_peakBox = nullptr;
+    QCheckBox* m_logBox = nullptr;
+    QCustomPlot* m_plot = nullptr;
+    QCPGraph* m_graph = nullptr;
+    QCPGraph* m_peakGraph = nullptr;
+    QCustomPlot* m_waterfallPlot = nullptr;
+    WaterfallMap* m_waterfall = nullptr;
+    QCPColorScale* m_colorScale = nullptr;
+    bool m_waterfallDirty = false;
+    bool m_waterfallAutoRange = true; // 下一行到来时按其数值设置色阶，布局改变或双击后重新设置
+
+    // 最近一次结果，下一帧转换为曲线数据
+    QVector<double> m_powerDb;
+    QVector<double> m_peakDb;
+    double m_sampleRate = 0.0;
+    bool m_dirty = false;
+    bool m_autoRange = true;  // 设置改变或双击后按数据重新缩放，拖动/缩放后保持用户视图
+    double m_shownBinHz = -1; // 上次显示的频率分辨率，变化时更新横轴标签
+    QVector<QCPGraphData> m_points;
+};
+
+#endif // SPECTRUMVIEW_H
@@ -0,0 +1,167 @@
+#include "spectrumworker.h"
+
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "channelregistry.h"
+#include "fftkernel.h"
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+} // namespace
+
+SpectrumWorker::SpectrumWorker(ChannelRegistry *registry, QObject *parent)
+    : QObject(parent)
+    , m_registry(registry)
+{
+    // 作为子对象随 moveToThread 一起移到工作线程
+    m_emitTimer = new QTimer(this);
+    m_emitTimer->setSingleShot(true);
+    connect(m_emitTimer, &QTimer::timeout, this, [this]() {
+        if (m_pending) emitSpectrum();
+    });
+}
+
+SpectrumWorker::~SpectrumWorker() = default;
+
+void SpectrumWorker::configure(int channel, int size, int window, int averages, bool peakHold)
+{
+    int n = kMinSize;
+    while (n * 2 <= std::min(size, kMaxSize)) n *= 2;
+    m_channel = channel;
+    m_size = n;
+    m_window = window == Blackman ? Blackman : Hann;
+    m_averages = std::max(1, averages);
+    m_peakHold = peakHold;
+    restart();
+}
+
+void SpectrumWorker::resetPeak()
+{
+    std::fill(m_peak.begin(), m_peak.end(), 0.0);
+}
+
+void SpectrumWorker::restart()
+{
+    if (!m_fft || m_fft->size() != m_size) m_fft = std::make_unique<RealFft>(m_size);
+    const std::size_t n = static_cast<std::size_t>(m_size);
+    const std::size_t bins = static_cast<std::size_t>(m_fft->bins());
+    m_coeffs.resize(n);
+    double sum = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const double x = 2.0 * kPi * static_cast<double>(i) / static_cast<double>(n);
+        m_coeffs[i] = m_window == Blackman ? 0.42 - 0.5 * std::cos(x) + 0.08 * std::cos(2.0 * x)
+                                           : 0.5 - 0.5 * std::cos(x);
+        sum += m_coeffs[i];
+    }
+    // 单边幅值 = 2|X| / Σw
+    m_scaleDb = 20.0 * std::log10(2.0 / sum);
+
+    m_ringValue.assign(n, 0.0);
+    m_ringTime.assign(n, 0);
+    m_ringPos = 0;
+    m_filled = 0;
+    m_sinceFrame = 0;
+    m_frame.resize(n);
+    m_power.assign(bins, 0.0);
+    m_average.assign(bins, 0.0);
+    m_peak.assign(bins, 0.0);
+    m_frames = 0;
+    m_sampleRate = 0.0;
+    m_pending = false;
+
+    // 从通道现有数据的最后一个窗口开始，切换后立即有谱
+    m_seq = 0;
+    if (const ChannelStore *store = m_registry && m_channel >= 0 ? m_registry->channel(m_channel) : nullptr) {
+        const quint64 total = store->totalCount();
+        m_seq = total > static_cast<quint64>(m_size) ? total - static_cast<quint64>(m_size) : 0;
+    }
+    ingest();
+}
+
+void SpectrumWorker::ingest()
+{
+    const ChannelStore *store = m_registry && m_channel >= 0 ? m_registry->channel(m_channel) : nullptr;
+    if (!store || !m_fft) return;
+    if (store->totalCount() < m_seq) { // 通道被清空过
+        m_seq = 0;
+        m_filled = 0;
+        m_ringPos = 0;
+        m_sinceFrame = 0;
+    }
+    m_readTime.clear();
+    m_readValues.clear();
+    m_seq = store->readSince(m_seq, m_readTime, m_readValues);
+    int n = static_cast<int>(m_readValues.size());
+    if (n == 0) return;
+
+    // 积压超过一个窗口时只有最后一个窗口有意义
+    int first = 0;
+    if (n > m_size) {
+        first = n - m_size;
+        m_sinceFrame = 0;
+    }
+    const int hop = m_size / 2;
+    for (int i = first; i < n; ++i) {
+        double v = m_readValues.at(i);
+        if (std::isnan(v)) v = 0.0;
+        m_ringValue[static_cast<std::size_t>(m_ringPos)] = v;
+        m_ringTime[static_cast<std::size_t>(m_ringPos)] = m_readTime.at(i);
+        m_ringPos = (m_ringPos + 1) % m_size;
+        if (m_filled < m_size) ++m_filled;
+        if (++m_sinceFrame >= hop && m_filled == m_size) {
+            m_sinceFrame = 0;
+            computeFrame();
+        }
+    }
+    if (!m_pending) return;
+    if (!m_emitClock.isValid() || m_emitClock.elapsed() >= kEmitIntervalMs) {
+        emitSpectrum();
+    } else if (!m_emitTimer->isActive()) {
+        m_emitTimer->start(static_cast<int>(kEmitIntervalMs - m_emitClock.elapsed()));
+    }
+}
+
+void SpectrumWorker::computeFrame()
+{
+    // 环形缓冲中 m_ringPos 处为最旧样本，按时间顺序展开并加窗
+    const std::size_t n = static_cast<std::size_t>(m_size);
+    const std::size_t head = static_cast<std::size_t>(m_ringPos);
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::size_t s = head + i < n ? head + i : head + i - n;
+        m_frame[i] = m_ringValue[s] * m_coeffs[i];
+    }
+    m_fft->powerSpectrum(m_frame.data(), m_power.data());
+
+    // 未满设定帧数时算术平均，之后按 1/averages 指数平均
+    m_frames = std::min(m_frames + 1, m_averages);
+    const double k = 1.0 / m_frames;
+    for (std::size_t b = 0; b < m_power.size(); ++b) {
+        m_average[b] += (m_power[b] - m_average[b]) * k;
+        if (m_peakHold) m_peak[b] = std::max(m_peak[b], m_power[b]);
+    }
+
+    const qint64 oldest = m_ringTime[head];
+    const qint64 newest = m_ringTime[head == 0 ? n - 1 : head - 1];
+    m_sampleRate = newest > oldest ? static_cast<double>(m_size - 1) * 1000.0 / static_cast<double>(newest - oldest) : 0.0;
+    m_pending = true;
+}
+
+void SpectrumWorker::emitSpectrum()
+{
+    auto toDb = [this](const std::vector<double> &power) {
+        QVector<double> db(static_cast<qsizetype>(power.size()));
+        const std::size_t last = power.size() - 1;
+        for (std::size_t b = 0; b < power.size(); ++b) {
+            // 直流与奈奎斯特频点在单边谱中不翻倍
+            const double edge = (b == 0 || b == last) ? -6.0206 : 0.0;
+            db[static_cast<qsizetype>(b)] = power[b] > 0 ? 10.0 * std::log10(power[b]) + m_scaleDb + edge
+                                                         : std::numeric_limits<double>::quiet_NaN(); // 功率为 0 时无 dB 值，曲线在此断开
+        }
+        return db;
+    };
+    m_pending = false;
+    m_emitClock.start();
+    emit spectrumReady(toDb(m_average), m_peakHold ? toDb(m_peak) : QVector<double>(), m_sampleRate);
+}
@@ -0,0 +1,78 @@
+#ifndef SPECTRUMWORKER_H
+#define SPECTRUMWORKER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QVector>
+#include <memory>
+#include <vector>
+
+class ChannelRegistry;
+class QTimer;
+class RealFft;
+
+// 频谱计算（运行在独立线程）：对选定通道维护最近 size 个样本的滑动窗口，
+// 每到半个窗口的新样本（50% 重叠）加窗做一次 FFT，按设定帧数平均并可保持峰值。
+// 幅度按窗的相干增益归一化为单边幅值谱（dB，幅值为 A 的正弦在对应频点约为 20·lg A），
+// 采样率由窗口内样本的时间戳估计。结果按 kEmitIntervalMs 节流后发出。
+class SpectrumWorker : public QObject
+{
+    Q_OBJECT
+public:
+    enum Window { Hann, Blackman };
+
+    explicit SpectrumWorker(ChannelRegistry *registry, QObject *parent = nullptr);
+    ~SpectrumWorker() override;
+
+    static constexpr int kMinSize = 256;
+    static constexpr int kMaxSize = 65536;
+    static constexpr int kEmitIntervalMs = 33;
+
+public slots:
+    // channel < 0 时停止计算；size 取不超过它的 2 的幂并限制在 [kMinSize, kMaxSize]
+    void configure(int channel, int size, int window, int averages, bool peakHold);
+    void resetPeak();
+    void ingest(); // 注册表有新数据时调用
+
+signals:
+    // powerDb / peakDb 为 size/2+1 个频点；sampleRate 为估计的采样率（Hz），无法估计时为 0；
+    // peakHold 关闭时 peakDb 为空；功率为 0 的频点为 NaN
+    void spectrumReady(const QVector<double> &powerDb, const QVector<double> &peakDb, double sampleRate);
+
+private:
+    void restart();
+    void computeFrame();
+    void emitSpectrum();
+
+    ChannelRegistry* m_registry = nullptr;
+    int m_channel = -1;
+    int m_size = 4096;
+    Window m_window = Hann;
+    int m_averages = 1;
+    bool m_peakHold = false;
+
+    quint64 m_seq = 0;
+    std::unique_ptr<RealFft> m_fft;
+    std::vector<double> m_coeffs;    // 窗函数
+    double m_scaleDb = 0.0;          // 幅值归一化对应的 dB 偏移
+    std::vector<double> m_ringValue; // 滑动窗口（环形）
+    std::vector<qint64> m_ringTime;
+    int m_ringPos = 0;   // 下一个写入位置，也是窗口内最旧样本的位置
+    int m_filled = 0;
+    int m_sinceFrame = 0; // 上一帧之后的新样本数
+    std::vector<double> m_frame;
+    std::vector<double> m_power;
+    std::vector<double> m_average;
+    std::vector<double> m_peak;
+    int m_frames = 0; // 已平均的帧数，未满 m_averages 时做算术平均
+    double m_sampleRate = 0.0;
+
+    bool m_pending = false; // 有未发出的新帧
+    QElapsedTimer m_emitClock;
+    QTimer* m_emitTimer = nullptr;
+
+    QVector<qint64> m_readTime;
+    QVector<double> m_readValues;
+};
+
+#endif // SPECTRUMWORKER_H
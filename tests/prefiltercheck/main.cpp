@@ -0,0 +1,86 @@
+// 对一组正则和文本行，比较开启预筛与关闭预筛时每条规则是否命中，两者必须完全一致。
+// 预筛只能少跑正则，不能让本该命中的规则被跳过。
+#include <QByteArray>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <cstdio>
+#include <vector>
+#include "patternprefilter.h"
+
+int main()
+{
+    const QStringList patterns = {
+        QStringLiteral("[[:digit:]]+"),
+        QStringLiteral("[[:alpha:]]]end"),
+        QStringLiteral("\\x41\\x42C"),
+        QStringLiteral("\\u0041BC"),
+        QStringLiteral("\\o{101}BC"),
+        QStringLiteral("(?<q>['\"])\\w+\\k<q>"),
+        QStringLiteral("(['\"])\\w+\\1"),
+        QStringLiteral("(?<v>\\d)\\g{v}x"),
+        QStringLiteral("\\p{Lu}ABC"),
+        QStringLiteral("\\N{U+0041}BC"),
+        QStringLiteral("\\QA.B\\E"),
+        QStringLiteral("temp=(-?\\d+(?:\\.\\d+)?)"),
+        QStringLiteral("ab[]x]cd"),
+        QStringLiteral("[^]a]xyz"),
+        QStringLiteral("ERR(?i)or"),
+        QStringLiteral("a{2}bc"),
+        QStringLiteral("colou?r"),
+        QStringLiteral("WARN|ERROR"),
+        QString::fromUtf8(u8"温度[:：]\\s*(\\d+)"),
+    };
+    const QStringList lines = {
+        QStringLiteral("123"),
+        QStringLiteral("x]end"),
+        QStringLiteral("ABC"),
+        QStringLiteral("'abc'"),
+        QStringLiteral("\"q\""),
+        QStringLiteral("11x"),
+        QStringLiteral("A.B"),
+        QStringLiteral("temp=-12.5"),
+        QStringLiteral("ab]cd"),
+        QStringLiteral("]xyz"),
+        QStringLiteral("ERROR"),
+        QStringLiteral("aabc"),
+        QStringLiteral("color"),
+        QStringLiteral("WARN"),
+        QString::fromUtf8(u8"温度： 36"),
+        QStringLiteral("nothing here"),
+        QString(),
+    };
+
+    PatternPrefilter prefilter;
+    std::vector<QRegularExpression> regexes;
+    for (const QString &pattern : patterns) {
+        const QByteArray utf8 = pattern.toUtf8();
+        prefilter.addRule(std::string(utf8.constData(), static_cast<std::size_t>(utf8.size())));
+        regexes.emplace_back(pattern);
+        if (!regexes.back().isValid()) {
+            std::printf("invalid pattern: %s\n", utf8.constData());
+            return 1;
+        }
+    }
+    prefilter.build();
+
+    int failures = 0;
+    std::vector<char> candidates;
+    for (const QString &line : lines) {
+        const QByteArray utf8 = line.toUtf8();
+        prefilter.scan(utf8.constData(), static_cast<std::size_t>(utf8.size()), candidates);
+        for (std::size_t i = 0; i < regexes.size(); ++i) {
+            const bool off = regexes[i].match(line).hasMatch();
+            const bool on = candidates[i] && off;
+            if (on == off) continue;
+            ++failures;
+            std::printf("MISMATCH pattern %s (literal \"%s\") on line \"%s\"\n",
+                        patterns.at(static_cast<qsizetype>(i)).toUtf8().constData(),
+                        PatternPrefilter::requiredLiteral(patterns.at(static_cast<qsizetype>(i)).toUtf8().toStdString()).c_str(),
+                        utf8.constData());
+        }
+    }
+    std::printf("%d patterns x %d lines, %d mismatches\n", static_cast<int>(patterns.size()),
+                static_cast<int>(lines.size()), failures);
+    return failures == 0 ? 0 : 1;
+}
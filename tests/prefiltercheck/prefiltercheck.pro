@@ -0,0 +1,14 @@
+# 预筛一致性检查：qmake && make && ./prefiltercheck，全部一致时返回 0
+QT       = core
+CONFIG  += c++17 console
+CONFIG  -= app_bundle
+TARGET   = prefiltercheck
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../patternprefilter.cpp
+
+HEADERS += \
+    ../../patternprefilter.h
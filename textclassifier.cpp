@@ -0,0 +1,175 @@
+#include "textclassifier.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HICOM_HAVE_SSE2 1
+#endif
+
+namespace {
+inline bool isControl(unsigned char c)
+{
+    if (c == 0x7F) return true;
+    if (c >= 0x20) return false;
+    return c != '\t' && c != '\r' && c != '\n' && c != 0x1B;
+}
+
+// 统计控制字符并返回第一个高位字节的位置（没有则返回 len）
+std::size_t scanAscii(const unsigned char *p, std::size_t len, std::size_t &controlBytes)
+{
+    std::size_t i = 0;
+#ifdef HICOM_HAVE_SSE2
+    const __m128i lowBound = _mm_set1_epi8(0x20);
+    const __m128i del = _mm_set1_epi8(0x7F);
+    for (; i + 16 <= len; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        if (_mm_movemask_epi8(v) != 0) break; // 出现高位字节
+        // 有符号比较：高位为 0 时等价于无符号比较
+        const int ctl = _mm_movemask_epi8(_mm_or_si128(_mm_cmplt_epi8(v, lowBound), _mm_cmpeq_epi8(v, del)));
+        if (ctl != 0) {
+            for (int k = 0; k < 16; ++k) {
+                if ((ctl & (1 << k)) && isControl(p[i + k])) ++controlBytes;
+            }
+        }
+    }
+#endif
+    for (; i < len; ++i) {
+        if (p[i] >= 0x80) break;
+        if (isControl(p[i])) ++controlBytes;
+    }
+    return i;
+}
+
+// 块尾被截断的多字节序列视为合法，由流式解码器在下一块补齐
+bool validateUtf8(const unsigned char *p, std::size_t len)
+{
+    std::size_t i = 0;
+    // 块首可能是上一块截断字符的后续字节
+    for (int k = 0; k < 3 && i < len && (p[i] & 0xC0) == 0x80; ++k) ++i;
+    while (i < len) {
+        const unsigned char c = p[i];
+        if (c < 0x80) { ++i; continue; }
+        int need;
+        unsigned char lo = 0x80, hi = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) { need = 1; }
+        else if (c == 0xE0) { need = 2; lo = 0xA0; }
+        else if (c >= 0xE1 && c <= 0xEC) { need = 2; }
+        else if (c == 0xED) { need = 2; hi = 0x9F; }
+        else if (c >= 0xEE && c <= 0xEF) { need = 2; }
+        else if (c == 0xF0) { need = 3; lo = 0x90; }
+        else if (c >= 0xF1 && c <= 0xF3) { need = 3; }
+        else if (c == 0xF4) { need = 3; hi = 0x8F; }
+        else return false;
+        ++i;
+        for (int k = 0; k < need; ++k, ++i) {
+            if (i >= len) return true;
+            const unsigned char t = p[i];
+            if (k == 0 ? (t < lo || t > hi) : ((t & 0xC0) != 0x80)) return false;
+        }
+    }
+    return true;
+}
+
+bool validateGb18030From(const unsigned char *p, std::size_t len, std::size_t i)
+{
+    while (i < len) {
+        const unsigned char c = p[i];
+        if (c < 0x80) { ++i; continue; }
+        if (c == 0x80 || c == 0xFF) return false;
+        if (i + 1 >= len) return true;
+        const unsigned char c2 = p[i + 1];
+        if ((c2 >= 0x40 && c2 <= 0x7E) || (c2 >= 0x80 && c2 <= 0xFE)) {
+            i += 2;
+            continue;
+        }
+        if (c2 < 0x30 || c2 > 0x39) return false;
+        if (i + 2 >= len) return true;
+        if (p[i + 2] < 0x81 || p[i + 2] > 0xFE) return false;
+        if (i + 3 >= len) return true;
+        if (p[i + 3] < 0x30 || p[i + 3] > 0x39) return false;
+        i += 4;
+    }
+    return true;
+}
+
+bool validateGb18030(const unsigned char *p, std::size_t len)
+{
+    // 块首可能落在双字节字符的第二个字节上，允许跳过一个字节重试
+    return validateGb18030From(p, len, 0) || (len > 1 && validateGb18030From(p, len, 1));
+}
+} // namespace
+
+ChunkStats classifyChunk(const char *data, std::size_t len)
+{
+    ChunkStats stats;
+    stats.length = len;
+    const unsigned char *p = reinterpret_cast<const unsigned char*>(data);
+
+    std::size_t i = scanAscii(p, len, stats.controlBytes);
+    if (i == len) {
+        stats.validUtf8 = true;
+        stats.validGb18030 = true;
+        return stats;
+    }
+    // 含高位字节：剩余部分逐段统计，ASCII 段依旧走向量路径
+    while (i < len) {
+        if (p[i] >= 0x80) {
+            ++stats.highBytes;
+            ++i;
+            continue;
+        }
+        i += scanAscii(p + i, len - i, stats.controlBytes);
+    }
+    stats.validUtf8 = validateUtf8(p, len);
+    stats.validGb18030 = validateGb18030(p, len);
+    return stats;
+}
+
+StreamClassifier::Kind StreamClassifier::judge(const ChunkStats &stats, Kind current)
+{
+    if (stats.length == 0) return current;
+    if (stats.printableRatio() < kMinPrintableRatio) return Binary;
+    if (stats.highBytes == 0) {
+        // 纯 ASCII 对两种编码都合法，沿用当前文本编码
+        return (current == TextGb18030) ? TextGb18030 : TextUtf8;
+    }
+    if (stats.validUtf8 && (current != TextGb18030 || !stats.validGb18030)) return TextUtf8;
+    if (stats.validGb18030) return TextGb18030;
+    return Binary;
+}
+
+StreamClassifier::Kind StreamClassifier::feed(const char *data, std::size_t len)
+{
+    const Kind k = judge(classifyChunk(data, len), m_current);
+    if (m_current == Undecided || k == m_current) {
+        m_current = k;
+        m_candidateCount = 0;
+        return m_current;
+    }
+    if (k != Binary && m_current != Binary) {
+        // 当前编码校验失败而另一种合法：解码错误是确定证据，立即切换
+        m_current = k;
+        m_candidateCount = 0;
+        return m_current;
+    }
+    // 文本与二进制之间的切换需要连续多块一致，避免偶发块来回抖动
+    if (k == m_candidate) {
+        ++m_candidateCount;
+    } else {
+        m_candidate = k;
+        m_candidateCount = 1;
+    }
+    if (m_candidateCount >= kSwitchAfter) {
+        m_current = k;
+        m_candidateCount = 0;
+        return m_current;
+    }
+    // 尚未切换：文本流中偶发的二进制块仍按 HEX 显示，避免乱码进入排版
+    return (k == Binary) ? Binary : m_current;
+}
+
+void StreamClassifier::reset()
+{
+    m_current = Undecided;
+    m_candidate = Undecided;
+    m_candidateCount = 0;
+}
@@ -0,0 +1,47 @@
+#ifndef TEXTCLASSIFIER_H
+#define TEXTCLASSIFIER_H
+
+#include <cstddef>
+
+// 按数据块判断文本/二进制，并识别 UTF-8 / GB18030 编码。
+// ASCII 段用 SSE2 一次处理 16 字节，只有遇到高位字节才走逐字节校验。
+struct ChunkStats {
+    std::size_t length = 0;
+    std::size_t controlBytes = 0;   // 除 \t \r \n \x1b 以外的控制字符及 0x7F
+    std::size_t highBytes = 0;      // >= 0x80 的字节
+    bool validUtf8 = false;
+    bool validGb18030 = false;
+
+    double printableRatio() const {
+        return length ? 1.0 - static_cast<double>(controlBytes) / static_cast<double>(length) : 1.0;
+    }
+};
+
+ChunkStats classifyChunk(const char *data, std::size_t len);
+
+class StreamClassifier {
+public:
+    enum Kind {
+        Undecided,
+        TextUtf8,
+        TextGb18030,
+        Binary
+    };
+
+    // 返回本块应采用的类型；判断结果带粘滞，连续多块不一致才切换
+    Kind feed(const char *data, std::size_t len);
+    Kind current() const { return m_current; }
+    void reset();
+
+private:
+    static Kind judge(const ChunkStats &stats, Kind current);
+
+    static constexpr int kSwitchAfter = 3;
+    static constexpr double kMinPrintableRatio = 0.95;
+
+    Kind m_current = Undecided;
+    Kind m_candidate = Undecided;
+    int m_candidateCount = 0;
+};
+
+#endif // TEXTCLASSIFIER_H
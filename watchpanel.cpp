@@ -0,0 +1,179 @@
+#include "watchpanel.h"
+
+#include <QDateTime>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+#include "channelregistry.h"
+
+namespace {
+enum Column { ColName, ColValue, ColRate, ColMin, ColMax, ColAge, ColumnCount };
+
+void setCell(QTableWidget *table, int row, int col, const QString &text)
+{
+    QTableWidgetItem *item = table->item(row, col);
+    if (!item) {
+        item = new QTableWidgetItem(text);
+        item->setFlags(item->flags() & ~Qt::ItemIsEditable);
+        table->setItem(row, col, item);
+    } else if (item->text() != text) {
+        item->setText(text);
+    }
+}
+
+QString formatAge(qint64 ms)
+{
+    if (ms < 1000) return QStringLiteral("%1 ms").arg(ms);
+    if (ms < 60000) return QStringLiteral("%1 s").arg(ms / 1000.0, 0, 'f', 1);
+    return QStringLiteral("%1 min").arg(ms / 60000);
+}
+} // namespace
+
+WatchPanel::WatchPanel(QWidget *parent)
+    : QWidget(parent)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 4, 4, 4);
+
+    m_table = new QTableWidget(0, ColumnCount, this);
+    m_table->setHorizontalHeaderLabels({QString::fromUtf8(u8"名称"), QString::fromUtf8(u8"最新值"),
+                                        QString::fromUtf8(u8"速率(Hz)"), QString::fromUtf8(u8"最小"),
+                                        QString::fromUtf8(u8"最大"), QString::fromUtf8(u8"距今")});
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    layout->addWidget(m_table);
+
+    QHBoxLayout *btnRow = new QHBoxLayout;
+    QPushButton *resetBtn = new QPushButton(QString::fromUtf8(u8"重置最值"), this);
+    btnRow->addStretch();
+    btnRow->addWidget(resetBtn);
+    layout->addLayout(btnRow);
+    connect(resetBtn, &QPushButton::clicked, this, &WatchPanel::resetRanges);
+
+    m_timer = new QTimer(this);
+    m_timer->setInterval(kRefreshMs);
+    connect(m_timer, &QTimer::timeout, this, &WatchPanel::refresh);
+    m_timer->start();
+}
+
+void WatchPanel::setRegistry(ChannelRegistry *registry)
+{
+    m_registry = registry;
+}
+
+void WatchPanel::setCustomRules(const QStringList &labels)
+{
+    m_hits.clear();
+    m_hits.resize(labels.size());
+    for (int i = 0; i < labels.size(); ++i) m_hits[i].label = labels.at(i);
+    m_hitsDirty = true;
+}
+
+void WatchPanel::setCustomHits(const QStringList &hits, const QVector<int> &rules)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (int i = 0; i < hits.size() && i < rules.size(); ++i) {
+        const int rule = rules.at(i);
+        if (rule < 0 || rule >= m_hits.size()) continue;
+        HitState &state = m_hits[rule];
+        state.value = hits.at(i);
+        state.lastMs = now;
+        ++state.count;
+        bool ok = false;
+        const double v = state.value.trimmed().toDouble(&ok);
+        if (ok) {
+            state.min = state.hasRange ? qMin(state.min, v) : v;
+            state.max = state.hasRange ? qMax(state.max, v) : v;
+            state.hasRange = true;
+        }
+    }
+}
+
+void WatchPanel::updateRate(RowState &state, quint64 count, qint64 now)
+{
+    if (state.lastTickMs > 0 && now > state.lastTickMs) {
+        const double instant = (count >= state.lastCount)
+                                   ? (count - state.lastCount) * 1000.0 / (now - state.lastTickMs)
+                                   : 0.0;
+        state.rate = state.rate * 0.7 + instant * 0.3;
+    }
+    state.lastCount = count;
+    state.lastTickMs = now;
+}
+
+void WatchPanel::ensureRows()
+{
+    const int count = m_registry ? m_registry->channelCount() : 0;
+    if (m_rows.size() >= count) return;
+    const QStringList names = m_registry->channelNames();
+    while (m_rows.size() < count) {
+        const int row = m_rows.size();
+        m_table->insertRow(row); // 通道行在前，命中行在后
+        setCell(m_table, row, ColName, names.value(row));
+        m_rows.append(RowState());
+    }
+}
+
+void WatchPanel::refresh()
+{
+    if (!isVisible()) return;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    ensureRows();
+
+    for (int id = 0; id < m_rows.size(); ++id) {
+        const ChannelStore *ch = m_registry->channel(id);
+        ChannelSnapshot snap;
+        if (!ch || !ch->snapshot(snap)) {
+            m_table->setRowHidden(id, true); // 尚无数据的通道不显示
+            continue;
+        }
+        m_table->setRowHidden(id, false);
+
+        RowState &state = m_rows[id];
+        updateRate(state, snap.count, now);
+
+        setCell(m_table, id, ColValue, QString::number(snap.value, 'g', 8));
+        setCell(m_table, id, ColRate, QString::number(state.rate, 'f', 1));
+        setCell(m_table, id, ColMin, QString::number(snap.min, 'g', 8));
+        setCell(m_table, id, ColMax, QString::number(snap.max, 'g', 8));
+        setCell(m_table, id, ColAge, formatAge(qMax<qint64>(0, now - snap.timestampMs)));
+    }
+
+    // 自定义匹配：每条规则固定一行，某一批没有命中时保留上次的值；还没命中过的规则不显示
+    const int base = m_rows.size();
+    if (m_hitsDirty) {
+        m_hitsDirty = false;
+        while (m_hitRows < m_hits.size()) m_table->insertRow(base + m_hitRows++);
+        while (m_hitRows > m_hits.size()) m_table->removeRow(base + --m_hitRows);
+        for (int i = 0; i < m_hits.size(); ++i) {
+            setCell(m_table, base + i, ColName, m_hits.at(i).label);
+            for (int col = ColValue; col < ColumnCount; ++col) setCell(m_table, base + i, col, QString());
+        }
+    }
+    for (int i = 0; i < m_hitRows; ++i) {
+        HitState &state = m_hits[i];
+        const int row = base + i;
+        m_table->setRowHidden(row, state.count == 0);
+        if (state.count == 0) continue;
+        updateRate(state.row, state.count, now);
+        setCell(m_table, row, ColValue, state.value);
+        setCell(m_table, row, ColRate, QString::number(state.row.rate, 'f', 1));
+        setCell(m_table, row, ColMin, state.hasRange ? QString::number(state.min, 'g', 8) : QString());
+        setCell(m_table, row, ColMax, state.hasRange ? QString::number(state.max, 'g', 8) : QString());
+        setCell(m_table, row, ColAge, formatAge(qMax<qint64>(0, now - state.lastMs)));
+    }
+}
+
+void WatchPanel::resetRanges()
+{
+    for (HitState &state : m_hits) state.hasRange = false;
+    if (!m_registry) return;
+    const int count = m_registry->channelCount();
+    for (int id = 0; id < count; ++id) {
+        if (ChannelStore *ch = m_registry->channel(id)) ch->resetRange();
+    }
+}
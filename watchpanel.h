@@ -0,0 +1,66 @@
+#ifndef WATCHPANEL_H
+#define WATCHPANEL_H
+
+#include <QStringList>
+#include <QVector>
+#include <QWidget>
+
+class ChannelRegistry;
+class QTableWidget;
+class QTimer;
+
+// 监视表：每个通道一行，显示最新值、更新速率、最小/最大值和距上次更新的时间；
+// 每条启用的自定义匹配规则也各占一行（按规则而不是按命中排列），显示最后命中的文本、命中速率、
+// 数值命中的最小/最大值和距上次命中的时间。
+// 数据从通道的无锁快照读取，固定 10 Hz 刷新且只在面板可见时刷新，与数据到达速率无关。
+class WatchPanel : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit WatchPanel(QWidget *parent = nullptr);
+
+    void setRegistry(ChannelRegistry *registry);
+
+    // 规则改变时调用，labels 为各条启用规则的显示名，清空各规则的状态
+    void setCustomRules(const QStringList &labels);
+    // 只保存，由定时器统一刷新；rules[i] 为 hits[i] 所属规则的序号
+    void setCustomHits(const QStringList &hits, const QVector<int> &rules);
+
+    static constexpr int kRefreshMs = 100;
+
+private slots:
+    void refresh();
+    void resetRanges();
+
+private:
+    struct RowState {
+        quint64 lastCount = 0;
+        qint64 lastTickMs = 0;
+        double rate = 0.0;
+    };
+
+    struct HitState {
+        QString label;
+        QString value;
+        quint64 count = 0;
+        qint64 lastMs = 0;
+        bool hasRange = false; // 有过数值命中
+        double min = 0.0;
+        double max = 0.0;
+        RowState row;
+    };
+
+    void ensureRows();
+    static void updateRate(RowState &state, quint64 count, qint64 now);
+
+    ChannelRegistry* m_registry = nullptr;
+    QTableWidget* m_table = nullptr;
+    QTimer* m_timer = nullptr;
+    QVector<RowState> m_rows; // 与通道序号一一对应
+
+    QVector<HitState> m_hits; // 与启用的自定义规则一一对应，行接在通道行之后
+    bool m_hitsDirty = false;
+    int m_hitRows = 0;
+};
+
+#endif // WATCHPANEL_H
@@ -0,0 +1,167 @@
+#include "waterfallmap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+WaterfallMap::WaterfallMap(QCPAxis *keyAxis, QCPAxis *valueAxis, int rows, int maxColumns)
+    : QCPAbstractPlottable(keyAxis, valueAxis)
+    , m_rows(std::max(1, rows))
+    , m_maxColumns(std::max(1, maxColumns))
+    , m_gradient(QCPColorGradient::gpJet)
+    , m_dataRange(-120.0, 0.0)
+{
+    setSelectable(QCP::stNone);
+    m_gradient.setNanHandling(QCPColorGradient::nhLowestColor);
+}
+
+void WaterfallMap::setGradient(const QCPColorGradient &gradient)
+{
+    m_gradient = gradient;
+    m_gradient.setNanHandling(QCPColorGradient::nhLowestColor);
+    for (int r = 0; r < m_filled; ++r) colorizeRow((m_head + r) % m_rows);
+}
+
+void WaterfallMap::setDataRange(const QCPRange &range)
+{
+    if (range == m_dataRange || !(range.size() > 0)) return;
+    m_dataRange = range;
+    // 只有改色阶时才整幅重新着色
+    for (int r = 0; r < m_filled; ++r) colorizeRow((m_head + r) % m_rows);
+}
+
+void WaterfallMap::setLayout(int bins, bool logFrequency, double binHz)
+{
+    if (!(binHz > 0)) binHz = 1.0;
+    const bool sameScale = std::abs(binHz - m_binHz) <= kBinHzTolerance * m_binHz;
+    if (bins == m_bins && logFrequency == m_log && sameScale && !m_firstBin.empty()) return;
+    m_bins = bins;
+    m_binHz = binHz;
+    m_log = logFrequency;
+    m_firstBin.clear();
+    m_endBin.clear();
+    m_columns = 0;
+    m_image = QImage();
+    m_raw.clear();
+    m_head = 0;
+    m_filled = 0;
+    if (bins < 2) return;
+
+    // 对数刻度不含直流频点；列数不超过可用频点数
+    m_lo = m_log ? 1.0 : 0.0;
+    m_hi = static_cast<double>(bins - 1);
+    const int available = bins - static_cast<int>(m_lo);
+    m_columns = std::min(m_maxColumns, available);
+    m_firstBin.resize(static_cast<std::size_t>(m_columns));
+    m_endBin.resize(static_cast<std::size_t>(m_columns));
+    // 绘制时各列在频率轴（线性或对数）上等宽，第 c 列覆盖频点坐标 [edge(c), edge(c + 1))
+    auto edge = [this](int c) {
+        const double t = static_cast<double>(c) / m_columns;
+        return m_log ? m_lo * std::pow(m_hi / m_lo, t) : m_lo + (m_hi - m_lo) * t;
+    };
+    for (int c = 0; c < m_columns; ++c) {
+        const double e0 = edge(c);
+        const double e1 = edge(c + 1);
+        int b0 = static_cast<int>(std::ceil(e0));
+        int b1 = (c + 1 == m_columns) ? bins : static_cast<int>(std::ceil(e1));
+        if (b1 <= b0) {
+            // 对数刻度低频端的列窄于一个频点：取离列中心最近的频点，不挤占后面的列，否则这些列会按线性间隔排开
+            const double center = m_log ? std::sqrt(e0 * e1) : 0.5 * (e0 + e1);
+            b0 = std::clamp(static_cast<int>(std::lround(center)), 0, bins - 1);
+            b1 = b0 + 1;
+        }
+        m_firstBin[static_cast<std::size_t>(c)] = b0;
+        m_endBin[static_cast<std::size_t>(c)] = b1;
+    }
+    m_raw.assign(static_cast<std::size_t>(m_columns) * static_cast<std::size_t>(m_rows),
+                 std::numeric_limits<double>::quiet_NaN());
+    m_image = QImage(m_columns, m_rows, QImage::Format_ARGB32);
+}
+
+void WaterfallMap::clear()
+{
+    m_head = 0;
+    m_filled = 0;
+}
+
+void WaterfallMap::addRow(const double *db, int bins)
+{
+    if (m_columns <= 0 || bins != m_bins) return;
+    // 新行写在最新行的上一行，从 m_head 往下依次变旧
+    m_head = (m_head + m_rows - 1) % m_rows;
+    m_filled = std::min(m_filled + 1, m_rows);
+    double *row = rawRow(m_head);
+    for (int c = 0; c < m_columns; ++c) {
+        const int b0 = m_firstBin[static_cast<std::size_t>(c)];
+        const int b1 = m_endBin[static_cast<std::size_t>(c)];
+        double mx = std::numeric_limits<double>::quiet_NaN();
+        for (int b = b0; b < b1 && b < bins; ++b) {
+            const double v = db[b];
+            if (!std::isnan(v) && (std::isnan(mx) || v > mx)) mx = v; // NaN 不参与
+        }
+        row[c] = mx;
+    }
+    colorizeRow(m_head);
+}
+
+void WaterfallMap::colorizeRow(int row)
+{
+    m_gradient.colorize(rawRow(row), m_dataRange, reinterpret_cast<QRgb *>(m_image.scanLine(row)), m_columns);
+}
+
+void WaterfallMap::draw(QCPPainter *painter)
+{
+    QCPAxis *keyAxis = mKeyAxis.data();
+    QCPAxis *valueAxis = mValueAxis.data();
+    if (!keyAxis || !valueAxis || m_filled == 0 || m_image.isNull()) return;
+
+    const double left = keyAxis->coordToPixel(m_lo * m_binHz);
+    const double right = keyAxis->coordToPixel(m_hi * m_binHz);
+    // 第 a 行（0 为最新）占纵轴 [a, a+1)。图像中 [m_head, m_rows) 依次为最新的若干行，其余接在 [0, m_head)。
+    // 按坐标把图像的一段行映射到目标区域，坐标轴反向时缩放系数为负，图像随之翻转
+    auto blit = [&](int firstImageRow, int firstAge, int count) {
+        if (count <= 0) return;
+        const double top = valueAxis->coordToPixel(firstAge);
+        const double bottom = valueAxis->coordToPixel(firstAge + count);
+        painter->save();
+        painter->translate(left, top);
+        painter->scale((right - left) / m_columns, (bottom - top) / count);
+        painter->drawImage(QRectF(0, 0, m_columns, count), m_image, QRectF(0, firstImageRow, m_columns, count));
+        painter->restore();
+    };
+    const int firstSpan = std::min(m_filled, m_rows - m_head);
+    blit(m_head, 0, firstSpan);
+    blit(0, firstSpan, m_filled - firstSpan);
+}
+
+void WaterfallMap::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
+{
+    QCPColorGradient gradient = m_gradient; // color() 会更新内部缓存，不能在 const 对象上调用
+    QLinearGradient lg(rect.topLeft(), rect.topRight());
+    lg.setColorAt(0, QColor::fromRgb(gradient.color(0, QCPRange(0, 1))));
+    lg.setColorAt(1, QColor::fromRgb(gradient.color(1, QCPRange(0, 1))));
+    painter->fillRect(rect, lg);
+}
+
+double WaterfallMap::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
+{
+    Q_UNUSED(pos)
+    Q_UNUSED(onlySelectable)
+    Q_UNUSED(details)
+    return -1;
+}
+
+QCPRange WaterfallMap::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
+{
+    Q_UNUSED(inSignDomain)
+    foundRange = m_columns > 0;
+    return QCPRange(m_lo * m_binHz, m_hi * m_binHz);
+}
+
+QCPRange WaterfallMap::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
+{
+    Q_UNUSED(inSignDomain)
+    Q_UNUSED(inKeyRange)
+    foundRange = true;
+    return QCPRange(0, m_rows);
+}
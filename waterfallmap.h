@@ -0,0 +1,68 @@
+#ifndef WATERFALLMAP_H
+#define WATERFALLMAP_H
+
+#include <QImage>
+#include <vector>
+#include "qcustomplot/qcustomplot.h"
+
+// 瀑布图：横轴为频率，纵轴为“几帧之前”（0 为最新，向下变旧）。
+// QCPColorMap 的数据一有改动就要在 updateMapImage 里把整幅图重新着色；这里按行环形索引：
+// 每到一帧只把这一行重采样到固定列数并着色一次，写进图像中的下一行，旧行原地不动，
+// 绘制时按环形偏移把图像分两段贴出。每帧的代价与历史行数无关。
+// 频点按列重采样（每列取所含频点的最大值，保留窄峰），对数频率时列按对数间隔划分，
+// 低频端不含任何频点的列取离列中心最近的频点（相邻列可能重复），每列都画在它真实的频率位置上。
+// 保留原始 dB 值，只在改变色阶范围或渐变时整幅重新着色。
+class WaterfallMap : public QCPAbstractPlottable
+{
+    Q_OBJECT
+public:
+    WaterfallMap(QCPAxis *keyAxis, QCPAxis *valueAxis, int rows, int maxColumns);
+
+    int rows() const { return m_rows; }
+    int filledRows() const { return m_filled; }
+
+    void setGradient(const QCPColorGradient &gradient);
+    QCPRange dataRange() const { return m_dataRange; }
+    void setDataRange(const QCPRange &range);
+
+    // 频点数、频率刻度改变，或频率分辨率 binHz 偏离超过 kBinHzTolerance 时清空历史并重建列划分。
+    // 采样率按毫秒时间戳逐帧估计，小的抖动不改变已固定的频率位置，否则整幅历史会每帧左右晃动
+    void setLayout(int bins, bool logFrequency, double binHz);
+    void clear();
+    // db 为 bins 个频点（与 setLayout 一致）
+    void addRow(const double *db, int bins);
+
+    static constexpr double kBinHzTolerance = 0.05; // 相对偏差
+
+    double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details = nullptr) const override;
+    QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth) const override;
+    QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth,
+                           const QCPRange &inKeyRange = QCPRange()) const override;
+
+protected:
+    void draw(QCPPainter *painter) override;
+    void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const override;
+
+private:
+    void colorizeRow(int row);
+    double *rawRow(int row) { return m_raw.data() + static_cast<std::size_t>(row) * static_cast<std::size_t>(m_columns); }
+
+    const int m_rows;
+    const int m_maxColumns;
+    int m_columns = 0;
+    int m_bins = 0;
+    bool m_log = false;
+    double m_lo = 0.0; // 图像左右边缘对应的频点序号
+    double m_hi = 0.0;
+    double m_binHz = 1.0;
+    std::vector<int> m_firstBin; // 第 c 列取频点 [m_firstBin[c], m_endBin[c]) 的最大值
+    std::vector<int> m_endBin;
+    std::vector<double> m_raw;   // 各行重采样后的 dB 值，与图像行一一对应
+    QImage m_image;
+    int m_head = 0;   // 最新一行所在的图像行
+    int m_filled = 0;
+    QCPColorGradient m_gradient;
+    QCPRange m_dataRange;
+};
+
+#endif // WATERFALLMAP_H
@@ -0,0 +1,845 @@
+#include "waveformview.h"
+
+#include <QApplication>
+#include <QColorDialog>
+#include <QComboBox>
+#include <QDateTime>
+#include <QDir>
+#include <QDoubleSpinBox>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QMouseEvent>
+#include <QPushButton>
+#include <QSignalBlocker>
+#include <QSpinBox>
+#include <QSplitter>
+#include <QStandardPaths>
+#include <QTableWidget>
+#include <QThread>
+#include <QTimer>
+#include <QVBoxLayout>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "channelregistry.h"
+#include "plottheme.h"
+#include "qcustomplot/qcustomplot.h"
+#include "renderscheduler.h"
+#include "wavegraph.h"
+
+namespace {
+enum Column { ColName, ColColor, ColAxis, ColumnCount };
+
+const QColor kTraceColors[] = {
+    QColor(Qt::green),     QColor(255, 193, 7),  QColor(33, 150, 243),  QColor(244, 67, 54),
+    QColor(171, 71, 188),  QColor(0, 188, 212),  QColor(255, 112, 67),  QColor(156, 204, 101),
+};
+constexpr int kTraceColorCount = static_cast<int>(sizeof(kTraceColors) / sizeof(kTraceColors[0]));
+constexpr int kHoverIntervalMs = 16; // 悬停查询的合并间隔，约一帧
+const QString kHoverLayer = QStringLiteral("overlay");
+const QColor kTriggerColor(255, 152, 0);
+
+// 自由运行时横轴为时:分:秒.毫秒，触发模式下为相对触发点的秒数（可为负）
+void setTimeTicker(QCPAxis *axis, bool relative)
+{
+    if (relative) {
+        axis->setTicker(QSharedPointer<QCPAxisTicker>(new QCPAxisTicker));
+        axis->setLabel(QString::fromUtf8(u8"相对触发时间 (s)"));
+        return;
+    }
+    // 减少刻度密度，避免拥挤
+    QSharedPointer<QCPAxisTickerTime> ticker(new QCPAxisTickerTime);
+    ticker->setTimeFormat(QStringLiteral("%h:%m:%s.%z"));
+    ticker->setTickStepStrategy(QCPAxisTicker::tssMeetTickCount);
+    ticker->setTickCount(6);
+    axis->setTicker(ticker);
+    axis->setLabel(QString::fromUtf8(u8"时间"));
+}
+} // namespace
+
+WaveformView::WaveformView(QWidget *parent)
+    : QWidget(parent)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    // 触发设置：深度以触发通道的样本数计
+    QHBoxLayout *triggerBar = new QHBoxLayout;
+    triggerBar->setContentsMargins(4, 4, 4, 0);
+    m_modeBox = new QComboBox(this);
+    m_modeBox->addItem(QString::fromUtf8(u8"自由运行"), FreeRun);
+    m_modeBox->addItem(QString::fromUtf8(u8"自动触发"), AutoTrigger);
+    m_modeBox->addItem(QString::fromUtf8(u8"常规触发"), NormalTrigger);
+    m_modeBox->addItem(QString::fromUtf8(u8"单次触发"), SingleTrigger);
+    m_modeBox->setToolTip(QString::fromUtf8(u8"自动：超过 %1 ms 未触发时显示最新窗口；常规：每次触发刷新；单次：触发一次后停止")
+                              .arg(kAutoTriggerMs));
+    m_triggerChannelBox = new QComboBox(this);
+    m_triggerChannelBox->setMinimumWidth(100);
+    m_edgeBox = new QComboBox(this);
+    m_edgeBox->addItem(QString::fromUtf8(u8"上升沿"), RisingEdge);
+    m_edgeBox->addItem(QString::fromUtf8(u8"下降沿"), FallingEdge);
+    m_edgeBox->addItem(QString::fromUtf8(u8"双沿"), AnyEdge);
+    m_levelBox = new QDoubleSpinBox(this);
+    m_levelBox->setRange(-1e9, 1e9);
+    m_levelBox->setDecimals(3);
+    m_preBox = new QSpinBox(this);
+    m_preBox->setRange(0, kMaxTriggerDepth);
+    m_preBox->setValue(m_trigger.pre);
+    m_preBox->setToolTip(QString::fromUtf8(u8"触发点之前显示的样本数"));
+    m_postBox = new QSpinBox(this);
+    m_postBox->setRange(0, kMaxTriggerDepth);
+    m_postBox->setValue(m_trigger.post);
+    m_postBox->setToolTip(QString::fromUtf8(u8"触发点之后显示的样本数"));
+    QPushButton *armButton = new QPushButton(QString::fromUtf8(u8"准备"), this);
+    armButton->setToolTip(QString::fromUtf8(u8"重新开始等待触发（单次模式采集后使用）"));
+    m_triggerStatus = new QLabel(this);
+    triggerBar->addWidget(new QLabel(QString::fromUtf8(u8"触发"), this));
+    triggerBar->addWidget(m_modeBox);
+    triggerBar->addWidget(new QLabel(QString::fromUtf8(u8"通道"), this));
+    triggerBar->addWidget(m_triggerChannelBox);
+    triggerBar->addWidget(m_edgeBox);
+    triggerBar->addWidget(new QLabel(QString::fromUtf8(u8"电平"), this));
+    triggerBar->addWidget(m_levelBox);
+    triggerBar->addWidget(new QLabel(QString::fromUtf8(u8"触发前"), this));
+    triggerBar->addWidget(m_preBox);
+    triggerBar->addWidget(new QLabel(QString::fromUtf8(u8"触发后"), this));
+    triggerBar->addWidget(m_postBox);
+    triggerBar->addWidget(armButton);
+    triggerBar->addWidget(m_triggerStatus);
+    triggerBar->addStretch(1);
+    layout->addLayout(triggerBar);
+    connect(m_modeBox, &QComboBox::currentIndexChanged, this, &WaveformView::applyTriggerSettings);
+    connect(m_triggerChannelBox, &QComboBox::currentIndexChanged, this, &WaveformView::applyTriggerSettings);
+    connect(m_edgeBox, &QComboBox::currentIndexChanged, this, &WaveformView::applyTriggerSettings);
+    connect(m_levelBox, &QDoubleSpinBox::valueChanged, this, &WaveformView::applyTriggerSettings);
+    connect(m_preBox, &QSpinBox::valueChanged, this, &WaveformView::applyTriggerSettings);
+    connect(m_postBox, &QSpinBox::valueChanged, this, &WaveformView::applyTriggerSettings);
+    connect(armButton, &QPushButton::clicked, this, &WaveformView::armTrigger);
+
+    QSplitter *splitter = new QSplitter(Qt::Horizontal, this);
+    layout->addWidget(splitter, 1);
+
+    m_plot = new QCustomPlot(splitter);
+    m_plot->yAxis->setLabel("Value");
+    m_plot->yAxis->setRange(0, 260);
+    m_plot->yAxis2->setRange(0, 260);
+    m_plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    if (QCPAxisRect *rect = m_plot->axisRect()) {
+        rect->setRangeDragAxes({m_plot->xAxis}, {m_plot->yAxis, m_plot->yAxis2});
+        rect->setRangeZoomAxes({m_plot->xAxis}, {m_plot->yAxis, m_plot->yAxis2});
+    }
+
+    // 横轴为自首个样本起的秒数
+    setTimeTicker(m_plot->xAxis, false);
+
+    const QColor bg = palette().color(QPalette::Base);
+    m_plot->setBackground(bg);
+    if (m_plot->axisRect()) {
+        m_plot->axisRect()->setBackground(bg);
+    }
+
+    connect(m_plot, &QCustomPlot::mouseDoubleClick, this, [this]() {
+        m_autoFollow = true;
+        followLatest();
+        scheduleReplot();
+    });
+    m_plot->installEventFilter(this);
+
+    // 悬停十字线和读数放在 overlay 层：该层有独立的绘制缓冲，刷新悬停时不必重画曲线
+    m_crosshair = new QCPItemTracer(m_plot);
+    m_crosshair->setLayer(kHoverLayer);
+    m_crosshair->setSelectable(false);
+    m_crosshair->setStyle(QCPItemTracer::tsCrosshair);
+    m_crosshair->position->setAxes(m_plot->xAxis, m_plot->yAxis);
+    m_crosshair->setVisible(false);
+    m_hoverLabel = new QCPItemText(m_plot);
+    m_hoverLabel->setLayer(kHoverLayer);
+    m_hoverLabel->setSelectable(false);
+    m_hoverLabel->position->setType(QCPItemPosition::ptAxisRectRatio);
+    m_hoverLabel->position->setAxisRect(m_plot->axisRect());
+    m_hoverLabel->position->setCoords(0.01, 0.01);
+    m_hoverLabel->setPositionAlignment(Qt::AlignLeft | Qt::AlignTop);
+    m_hoverLabel->setTextAlignment(Qt::AlignLeft);
+    m_hoverLabel->setPadding(QMargins(4, 2, 4, 2));
+    m_hoverLabel->setVisible(false);
+    // 触发电平与触发时刻，只在触发模式下显示
+    m_levelLine = new QCPItemStraightLine(m_plot);
+    m_zeroLine = new QCPItemStraightLine(m_plot);
+    for (QCPItemStraightLine *line : {m_levelLine, m_zeroLine}) {
+        line->setSelectable(false);
+        line->setPen(QPen(kTriggerColor, 1, Qt::DashLine));
+        line->setVisible(false);
+    }
+    m_zeroLine->point1->setCoords(0, 0);
+    m_zeroLine->point2->setCoords(0, 1);
+
+    m_hoverTimer = new QTimer(this);
+    m_hoverTimer->setSingleShot(true);
+    m_hoverTimer->setInterval(kHoverIntervalMs);
+    connect(m_hoverTimer, &QTimer::timeout, this, [this]() {
+        updateHover();
+        m_plot->layer(kHoverLayer)->replot();
+    });
+
+    // 通道列表：勾选显示，双击颜色格改颜色，下拉框选坐标轴；下方是历史导出与统计
+    QWidget *panel = new QWidget(splitter);
+    QVBoxLayout *panelLayout = new QVBoxLayout(panel);
+    panelLayout->setContentsMargins(0, 0, 0, 0);
+    m_table = new QTableWidget(0, ColumnCount, panel);
+    m_table->setHorizontalHeaderLabels({QString::fromUtf8(u8"通道"), QString::fromUtf8(u8"颜色"),
+                                        QString::fromUtf8(u8"坐标轴")});
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(ColName, QHeaderView::Stretch);
+    m_table->horizontalHeader()->setSectionResizeMode(ColColor, QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setSectionResizeMode(ColAxis, QHeaderView::ResizeToContents);
+    m_table->setSelectionMode(QAbstractItemView::NoSelection);
+    connect(m_table, &QTableWidget::cellChanged, this, &WaveformView::onCellChanged);
+    connect(m_table, &QTableWidget::cellDoubleClicked, this, &WaveformView::onCellDoubleClicked);
+    panelLayout->addWidget(m_table);
+
+    QHBoxLayout *buttons = new QHBoxLayout;
+    QPushButton *exportButton = new QPushButton(QString::fromUtf8(u8"导出…"), panel);
+    exportButton->setToolTip(QString::fromUtf8(u8"把勾选通道的全部历史导出为 CSV"));
+    QPushButton *statsButton = new QPushButton(QString::fromUtf8(u8"统计"), panel);
+    statsButton->setToolTip(QString::fromUtf8(u8"勾选通道全部历史的样本数、最值与均值"));
+    connect(exportButton, &QPushButton::clicked, this, &WaveformView::exportHistory);
+    connect(statsButton, &QPushButton::clicked, this, &WaveformView::showStatistics);
+    buttons->addWidget(exportButton);
+    buttons->addWidget(statsButton);
+    panelLayout->addLayout(buttons);
+
+    splitter->addWidget(m_plot);
+    splitter->addWidget(panel);
+    splitter->setStretchFactor(0, 4);
+    splitter->setStretchFactor(1, 1);
+
+    // 历史文件放在本次会话的临时目录中，与日志分段同处一处
+    QString base = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    if (base.isEmpty()) base = QDir::tempPath() + QLatin1String("/HiCOM");
+    m_archiveDir = base + QLatin1String("/wave/session_")
+                   + QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd_hhmmss_zzz"));
+    if (!QDir().mkpath(m_archiveDir)) m_archiveDir.clear();
+}
+
+WaveformView::~WaveformView()
+{
+    // 导出线程读的是这些文件，等它结束后再关闭并删除
+    if (m_exportThread) m_exportThread->wait();
+    for (auto &trace : m_traces) trace->graph->setArchive(nullptr);
+    if (!m_archiveDir.isEmpty()) QDir(m_archiveDir).removeRecursively();
+}
+
+void WaveformView::setRegistry(ChannelRegistry *registry)
+{
+    m_registry = registry;
+    if (!m_registry) return;
+    // 先连接再同步，避免漏掉连接前后新增的通道
+    connect(m_registry, &ChannelRegistry::channelAdded, this, &WaveformView::syncChannels, Qt::QueuedConnection);
+    connect(m_registry, &ChannelRegistry::channelsCleared, this, &WaveformView::clearTraces, Qt::QueuedConnection);
+    connect(m_registry, &ChannelRegistry::samplesAppended, this, &WaveformView::ingest, Qt::QueuedConnection);
+    syncChannels();
+}
+
+void WaveformView::applyTheme(bool dark)
+{
+    applyPlotTheme(m_plot, dark);
+    const PlotPalette p = plotPalette(dark);
+    m_crosshair->setPen(QPen(p.grid.lighter(dark ? 150 : 80), 1, Qt::DashLine));
+    m_hoverLabel->setColor(p.axis);
+    m_hoverLabel->setBrush(QColor(p.background.red(), p.background.green(), p.background.blue(), 200));
+    scheduleReplot();
+}
+
+void WaveformView::syncChannels()
+{
+    if (!m_registry) return;
+    const int count = m_registry->channelCount();
+    if (static_cast<int>(m_traces.size()) >= count) return;
+    const QStringList names = m_registry->channelNames();
+
+    QSignalBlocker blocker(m_table);
+    QSignalBlocker channelBlocker(m_triggerChannelBox);
+    while (static_cast<int>(m_traces.size()) < count) {
+        const int id = static_cast<int>(m_traces.size());
+        auto trace = std::make_unique<Trace>();
+        trace->channel = id;
+        trace->graph = new WaveGraph(m_plot->xAxis, m_plot->yAxis, kMaxPoints); // 构造时即登记到 m_plot
+        trace->graph->setName(names.value(id));
+        trace->graph->setUniformTolerance(kUniformTolerance);
+        if (!m_archiveDir.isEmpty()) {
+            auto archive = std::make_unique<SampleArchive>(m_archiveDir + QStringLiteral("/ch%1.col").arg(id));
+            if (archive->isOpen()) trace->graph->setArchive(std::move(archive)); // 打不开时只保留内存中的历史
+        }
+
+        m_table->insertRow(id);
+        QTableWidgetItem *nameItem = new QTableWidgetItem(names.value(id));
+        nameItem->setFlags(Qt::ItemIsEnabled | Qt::ItemIsUserCheckable);
+        nameItem->setCheckState(Qt::Checked);
+        m_table->setItem(id, ColName, nameItem);
+        QTableWidgetItem *colorItem = new QTableWidgetItem;
+        colorItem->setFlags(Qt::ItemIsEnabled);
+        colorItem->setToolTip(QString::fromUtf8(u8"双击修改颜色"));
+        m_table->setItem(id, ColColor, colorItem);
+        QComboBox *axisBox = new QComboBox(m_table);
+        axisBox->addItems({QString::fromUtf8(u8"左"), QString::fromUtf8(u8"右")});
+        connect(axisBox, &QComboBox::currentIndexChanged, this, [this, id](int index) {
+            setTraceAxis(*m_traces[static_cast<std::size_t>(id)], index == 1);
+            if (m_autoFollow) followLatest();
+            scheduleReplot();
+        });
+        m_table->setCellWidget(id, ColAxis, axisBox);
+
+        trace->marker = new QCPItemTracer(m_plot);
+        trace->marker->setLayer(kHoverLayer);
+        trace->marker->setSelectable(false);
+        trace->marker->setStyle(QCPItemTracer::tsCircle);
+        trace->marker->setSize(7);
+        trace->marker->position->setAxes(m_plot->xAxis, m_plot->yAxis);
+        trace->marker->setVisible(false);
+        trace->capture = m_plot->addGraph(m_plot->xAxis, m_plot->yAxis);
+        setTraceColor(*trace, kTraceColors[id % kTraceColorCount]);
+        applyTraceVisibility(*trace);
+        m_traces.push_back(std::move(trace));
+        m_triggerChannelBox->addItem(names.value(id), id);
+    }
+    updateTriggerLevelLine();
+}
+
+void WaveformView::clearTraces()
+{
+    for (auto &trace : m_traces) {
+        trace->graph->clear();
+        trace->seq = 0;
+        trace->stale = false;
+        trace->capture->data()->clear();
+    }
+    m_hasCapture = false;
+    m_trigger.pending = false;
+    m_trigger.scanFrom = 0;
+    m_trigger.captures = 0;
+    m_trigger.sinceCapture.start();
+    updateTriggerStatus();
+    m_hasTimeOrigin = false;
+    m_autoFollow = true;
+    if (m_hoverActive) updateHover();
+    scheduleReplot();
+}
+
+void WaveformView::setTraceColor(Trace &trace, const QColor &color)
+{
+    trace.color = color;
+    trace.graph->setPen(QPen(color));
+    trace.capture->setPen(QPen(color));
+    trace.marker->setPen(QPen(color, 1.5));
+    if (QTableWidgetItem *item = m_table->item(trace.channel, ColColor)) {
+        QSignalBlocker blocker(m_table);
+        item->setBackground(color);
+    }
+}
+
+void WaveformView::setTraceAxis(Trace &trace, bool right)
+{
+    trace.rightAxis = right;
+    trace.graph->setValueAxis(right ? m_plot->yAxis2 : m_plot->yAxis);
+    trace.capture->setValueAxis(right ? m_plot->yAxis2 : m_plot->yAxis);
+    trace.marker->position->setAxes(m_plot->xAxis, right ? m_plot->yAxis2 : m_plot->yAxis);
+    // 右轴只在有通道使用时显示
+    const bool anyRight = std::any_of(m_traces.begin(), m_traces.end(),
+                                      [](const std::unique_ptr<Trace> &t) { return t->rightAxis; });
+    m_plot->yAxis2->setVisible(anyRight);
+    if (trace.channel == m_trigger.channel) updateTriggerLevelLine();
+}
+
+void WaveformView::applyTraceVisibility(Trace &trace)
+{
+    // 自由运行显示历史曲线，触发模式显示捕获窗口
+    trace.graph->setVisible(trace.visible && !triggerActive());
+    trace.capture->setVisible(trace.visible && triggerActive());
+}
+
+void WaveformView::onCellChanged(int row, int column)
+{
+    if (column != ColName || row < 0 || row >= static_cast<int>(m_traces.size())) return;
+    Trace &trace = *m_traces[static_cast<std::size_t>(row)];
+    trace.visible = m_table->item(row, ColName)->checkState() == Qt::Checked;
+    applyTraceVisibility(trace);
+    if (trace.visible) pullTrace(trace); // 隐藏期间只写了历史文件，重新显示时重建曲线缓冲
+    if (m_autoFollow) followLatest();
+    if (m_hoverActive) updateHover();
+    scheduleReplot();
+}
+
+void WaveformView::onCellDoubleClicked(int row, int column)
+{
+    if (column != ColColor || row < 0 || row >= static_cast<int>(m_traces.size())) return;
+    Trace &trace = *m_traces[static_cast<std::size_t>(row)];
+    const QColor color = QColorDialog::getColor(trace.color, this, QString::fromUtf8(u8"通道颜色"));
+    if (!color.isValid()) return;
+    setTraceColor(trace, color);
+    scheduleReplot();
+}
+
+void WaveformView::exportHistory()
+{
+    if (m_exportThread) {
+        QMessageBox::information(this, QString::fromUtf8(u8"导出波形"), QString::fromUtf8(u8"上一次导出尚未完成。"));
+        return;
+    }
+    QVector<SampleArchive::ExportSource> sources;
+    QStringList truncated;
+    for (const auto &trace : m_traces) {
+        const SampleArchive *archive = trace->graph->archive();
+        if (trace->visible && archive && !archive->isEmpty()) {
+            sources.append(archive->exportSource(trace->graph->name()));
+            if (archive->hasFailed()) truncated << trace->graph->name();
+        }
+    }
+    if (sources.isEmpty()) {
+        QMessageBox::information(this, QString::fromUtf8(u8"导出波形"), QString::fromUtf8(u8"勾选的通道没有可导出的历史数据。"));
+        return;
+    }
+    const QString path = QFileDialog::getSaveFileName(
+        this, QString::fromUtf8(u8"导出波形"),
+        QDir::homePath() + QLatin1String("/hicom_wave_") + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + ".csv",
+        QString::fromUtf8(u8"CSV 文件 (*.csv);;所有文件 (*.*)"));
+    if (path.isEmpty()) return;
+
+    // 数据量可达数百 MB，在后台线程上顺序读取已落盘的块；界面继续追加新块不影响已记录的块数
+    QPointer<WaveformView> self(this);
+    m_exportThread = QThread::create([self, sources, path, truncated]() {
+        QString error;
+        const bool ok = SampleArchive::exportCsv(sources, path, &error);
+        QMetaObject::invokeMethod(qApp, [self, ok, error, path, truncated]() {
+            if (!self) return;
+            if (ok && !truncated.isEmpty()) {
+                QMessageBox::warning(self, QString::fromUtf8(u8"导出波形"),
+                                     QString::fromUtf8(u8"已导出到 %1\n%2 的历史文件写入失败过，只导出了失败前的数据。")
+                                         .arg(path, truncated.join(QStringLiteral(", "))));
+            } else if (ok) {
+                QMessageBox::information(self, QString::fromUtf8(u8"导出波形"), QString::fromUtf8(u8"已导出到 %1").arg(path));
+            } else {
+                QMessageBox::warning(self, QString::fromUtf8(u8"导出失败"), error);
+            }
+        }, Qt::QueuedConnection);
+    });
+    connect(m_exportThread, &QThread::finished, m_exportThread, &QObject::deleteLater);
+    m_exportThread->start();
+}
+
+void WaveformView::showStatistics()
+{
+    // 只遍历块摘要和未满一块的尾部，与历史长度基本无关
+    QStringList lines;
+    for (const auto &trace : m_traces) {
+        const SampleArchive *archive = trace->graph->archive();
+        if (!trace->visible || !archive || archive->isEmpty()) continue;
+        const SampleArchive::Stats st = archive->stats();
+        lines << QString::fromUtf8(u8"%1：%2 个样本，时间 %3 ~ %4 s，最小 %5，最大 %6，均值 %7")
+                     .arg(trace->graph->name())
+                     .arg(st.count)
+                     .arg(QString::number(st.firstKey, 'f', 3), QString::number(st.lastKey, 'f', 3),
+                          QString::number(st.min, 'g', 6), QString::number(st.max, 'g', 6),
+                          QString::number(st.mean, 'g', 6));
+        if (archive->hasFailed()) lines.last() += QString::fromUtf8(u8"（历史文件写入失败，只含失败前的数据）");
+    }
+    if (lines.isEmpty()) lines << QString::fromUtf8(u8"勾选的通道没有历史数据。");
+    QMessageBox::information(this, QString::fromUtf8(u8"波形统计"), lines.join(QLatin1Char('\n')));
+}
+
+void WaveformView::ingest()
+{
+    if (!m_registry) return;
+    bool changed = false;
+    for (auto &trace : m_traces) {
+        // 全部通道都拉取，隐藏的只写历史文件，不引起重绘
+        if (pullTrace(*trace) && needsSeries(*trace)) changed = true;
+    }
+    // 触发模式下历史照常记录，只有捕获到新窗口才重绘
+    if (triggerActive()) changed = processTrigger();
+    // 只标脏，跟随、悬停刷新和重绘合并到下一帧
+    if (changed) requestFrame();
+}
+
+void WaveformView::applyTriggerSettings()
+{
+    const bool wasActive = triggerActive();
+    m_trigger.mode = static_cast<TriggerMode>(m_modeBox->currentData().toInt());
+    m_trigger.channel = m_triggerChannelBox->count() > 0 ? m_triggerChannelBox->currentData().toInt() : 0;
+    m_trigger.edge = static_cast<TriggerEdge>(m_edgeBox->currentData().toInt());
+    m_trigger.level = m_levelBox->value();
+    m_trigger.pre = m_preBox->value();
+    m_trigger.post = m_postBox->value();
+    if (triggerActive() != wasActive) {
+        for (auto &trace : m_traces) applyTraceVisibility(*trace);
+        setTimeTicker(m_plot->xAxis, triggerActive());
+        m_levelLine->setVisible(triggerActive());
+        m_zeroLine->setVisible(triggerActive());
+        m_autoFollow = true;
+        if (m_hoverActive) updateHover();
+    }
+    updateTriggerLevelLine();
+    armTrigger();
+    if (m_autoFollow) followLatest();
+    scheduleReplot();
+}
+
+void WaveformView::armTrigger()
+{
+    // 只检测准备之后到达的样本，已显示的捕获窗口保留到下一次触发
+    m_trigger.armed = triggerActive();
+    m_trigger.pending = false;
+    m_trigger.scanFrom = 0;
+    if (m_trigger.channel >= 0 && m_trigger.channel < static_cast<int>(m_traces.size())) {
+        m_trigger.scanFrom = m_traces[static_cast<std::size_t>(m_trigger.channel)]->seq;
+    }
+    m_trigger.sinceCapture.start();
+    updateTriggerStatus();
+}
+
+bool WaveformView::processTrigger()
+{
+    if (!m_trigger.armed || m_trigger.channel < 0 || m_trigger.channel >= static_cast<int>(m_traces.size())) return false;
+    const Trace &source = *m_traces[static_cast<std::size_t>(m_trigger.channel)];
+    const WaveSeries &series = source.graph->series();
+    if (series.isEmpty()) return false;
+    // 曲线中保存的是通道序号 [base, end) 的样本
+    const quint64 end = source.seq;
+    const quint64 base = end - static_cast<quint64>(series.size());
+    if (m_trigger.scanFrom > end || (m_trigger.pending && m_trigger.at >= end)) { // 通道被清空过
+        m_trigger.pending = false;
+        m_trigger.scanFrom = base;
+    }
+
+    // 积压的数据中可能有多次触发，逐次检测以免漏掉，但只复制最后一个完整的窗口
+    bool captured = false;
+    quint64 shownAt = 0;
+    while (m_trigger.armed) {
+        if (!m_trigger.pending && !findTrigger(series, base, end)) break;
+        if (end <= m_trigger.at + static_cast<quint64>(m_trigger.post)) break; // 触发后的样本还没到齐
+        captured = true;
+        shownAt = m_trigger.at;
+        ++m_trigger.captures;
+        m_trigger.pending = false;
+        m_trigger.scanFrom = m_trigger.at + static_cast<quint64>(m_trigger.post) + 1;
+        if (m_trigger.mode == SingleTrigger) m_trigger.armed = false;
+    }
+    if (!captured && !m_trigger.pending && m_trigger.mode == AutoTrigger
+        && m_trigger.sinceCapture.elapsed() >= kAutoTriggerMs) {
+        // 超时未触发：显示以最新样本结束的窗口，继续从这里检测
+        const quint64 post = static_cast<quint64>(m_trigger.post);
+        shownAt = end - 1 >= base + post ? end - 1 - post : base;
+        captured = true;
+    }
+    if (!captured) return false;
+    m_trigger.sinceCapture.start();
+    captureWindow(shownAt, series, base);
+    updateTriggerStatus();
+    return true;
+}
+
+bool WaveformView::findTrigger(const WaveSeries &series, quint64 base, quint64 end)
+{
+    // 逐个比较相邻样本与电平；NaN 参与的比较都为假，不会触发
+    const double level = m_trigger.level;
+    for (quint64 i = std::max(m_trigger.scanFrom, base + 1); i < end; ++i) {
+        const double prev = series.valueAt(static_cast<int>(i - 1 - base));
+        const double v = series.valueAt(static_cast<int>(i - base));
+        const bool rising = prev < level && v >= level;
+        const bool falling = prev > level && v <= level;
+        if ((rising && m_trigger.edge != FallingEdge) || (falling && m_trigger.edge != RisingEdge)) {
+            m_trigger.pending = true;
+            m_trigger.at = i;
+            m_trigger.scanFrom = i + 1;
+            return true;
+        }
+    }
+    m_trigger.scanFrom = end;
+    return false;
+}
+
+void WaveformView::captureWindow(quint64 at, const WaveSeries &series, quint64 base)
+{
+    // 触发通道上 [at - pre, at + post] 对应的时间窗口，各通道按时间取各自的样本
+    const quint64 last = base + static_cast<quint64>(series.size()) - 1;
+    auto keyOf = [&](quint64 seq) { return series.keyAt(static_cast<int>(std::clamp(seq, base, last) - base)); };
+    const quint64 pre = static_cast<quint64>(m_trigger.pre);
+    const double t0 = keyOf(at);
+    const double lower = keyOf(at >= base + pre ? at - pre : base);
+    const double upper = keyOf(at + static_cast<quint64>(m_trigger.post));
+
+    QVector<QCPGraphData> points;
+    for (auto &trace : m_traces) {
+        const WaveSeries &s = trace->graph->series();
+        points.clear();
+        if (trace->visible && !s.isEmpty()) {
+            const int first = s.lowerBound(lower);
+            const int stop = s.upperBound(upper);
+            points.reserve(std::max(0, stop - first));
+            for (int i = first; i < stop; ++i) points.append(QCPGraphData(s.keyAt(i) - t0, s.valueAt(i)));
+        }
+        trace->capture->data()->set(points, true);
+    }
+    m_captureLower = lower - t0;
+    m_captureUpper = std::max(upper - t0, m_captureLower + 1e-3);
+    m_hasCapture = true;
+    m_captureDirty = true;
+}
+
+void WaveformView::updateTriggerLevelLine()
+{
+    const bool right = m_trigger.channel >= 0 && m_trigger.channel < static_cast<int>(m_traces.size())
+                       && m_traces[static_cast<std::size_t>(m_trigger.channel)]->rightAxis;
+    QCPAxis *valueAxis = right ? m_plot->yAxis2 : m_plot->yAxis;
+    m_levelLine->point1->setAxes(m_plot->xAxis, valueAxis);
+    m_levelLine->point2->setAxes(m_plot->xAxis, valueAxis);
+    m_levelLine->point1->setCoords(0, m_trigger.level);
+    m_levelLine->point2->setCoords(1, m_trigger.level);
+}
+
+void WaveformView::updateTriggerStatus()
+{
+    if (!triggerActive()) {
+        m_triggerStatus->clear();
+        return;
+    }
+    const QString state = m_trigger.armed ? QString::fromUtf8(u8"等待触发") : QString::fromUtf8(u8"已停止");
+    m_triggerStatus->setText(m_trigger.captures > 0
+                                 ? QString::fromUtf8(u8"%1，已触发 %2 次").arg(state).arg(m_trigger.captures)
+                                 : state);
+}
+
+void WaveformView::setScheduler(RenderScheduler *scheduler)
+{
+    m_scheduler = scheduler;
+    if (m_scheduler) m_scheduler->addPlot(m_plot, [this]() { return prepareFrame(); });
+}
+
+void WaveformView::scheduleReplot()
+{
+    m_viewDirty = true;
+    requestFrame();
+}
+
+void WaveformView::requestFrame()
+{
+    if (m_scheduler) m_scheduler->markDirty(m_plot);
+    else if (prepareFrame()) m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+bool WaveformView::prepareFrame()
+{
+    bool dataChanged = false;
+    for (auto &trace : m_traces) {
+        dataChanged = dataChanged || trace->dirty;
+        trace->dirty = false;
+    }
+    if (triggerActive()) dataChanged = m_captureDirty; // 触发模式只显示捕获窗口
+    m_captureDirty = false;
+    if (!dataChanged && !m_viewDirty) return false;
+    m_viewDirty = false;
+    if (dataChanged) {
+        if (m_autoFollow) followLatest();
+        if (m_hoverActive) updateHover(); // 跟随时鼠标下的样本随数据变化
+    }
+    return true;
+}
+
+bool WaveformView::needsSeries(const Trace &trace) const
+{
+    // 触发通道即使隐藏也要有曲线缓冲，才能检测触发；没有历史文件时缓冲是唯一的记录
+    const SampleArchive *archive = trace.graph->archive();
+    return trace.visible || (triggerActive() && trace.channel == m_trigger.channel) || !archive || !archive->isOpen();
+}
+
+void WaveformView::reportArchiveFailure(const Trace &trace)
+{
+    if (m_archiveWarned) return;
+    m_archiveWarned = true;
+    const SampleArchive *archive = trace.graph->archive();
+    const QString message = QString::fromUtf8(u8"通道 %1 的历史文件写入失败（%2），之后的数据只保留在内存中，"
+                                              u8"导出和统计只包含失败前记录的部分。")
+                                .arg(trace.graph->name(), archive ? archive->errorString() : QString());
+    // 拉取过程中不弹模态框，排到事件循环里
+    QTimer::singleShot(0, this, [this, message]() {
+        QMessageBox::warning(this, QString::fromUtf8(u8"波形历史"), message);
+    });
+}
+
+bool WaveformView::pullTrace(Trace &trace)
+{
+    const ChannelStore *store = m_registry ? m_registry->channel(trace.channel) : nullptr;
+    if (!store) return false;
+
+    quint64 from = trace.seq;
+    const quint64 total = store->totalCount();
+    if (total < from) {
+        // 通道被清空过，从头读
+        trace.graph->clear();
+        trace.stale = false;
+        from = 0;
+    }
+    // 积压过多时只取曲线缓冲能保留的部分
+    if (total > from + kMaxPoints) from = total - kMaxPoints;
+
+    const bool keepSeries = needsSeries(trace);
+    if (keepSeries && trace.stale) {
+        // 隐藏期间只写了历史文件，先用文件末尾重建曲线缓冲，缓冲仍对应通道序号 [seq - size, seq)
+        trace.graph->reloadFromArchive(kMaxPoints);
+        trace.stale = false;
+        trace.dirty = true;
+    }
+
+    m_readTime.clear();
+    m_readValues.clear();
+    const quint64 next = store->readSince(from, m_readTime, m_readValues);
+    trace.seq = next;
+    int n = static_cast<int>(m_readValues.size());
+    if (n == 0) return false;
+    if (n > kMaxPoints) {
+        m_readTime.remove(0, n - kMaxPoints);
+        m_readValues.remove(0, n - kMaxPoints);
+        n = kMaxPoints;
+    }
+
+    // 键为到达时间（相对所有通道共同的起点，秒），不同速率的通道在同一时间轴上对齐，
+    // 突发与断流也如实显示。系统时间回拨时钳位，保证键单调不减。
+    // 新样本直接写入曲线的环形缓冲，满后覆盖最旧的点，不复制已有数据
+    if (!m_hasTimeOrigin) {
+        m_timeOriginMs = m_readTime.first();
+        m_hasTimeOrigin = true;
+    }
+    m_readKeys.resize(n);
+    const bool empty = trace.graph->series().isEmpty() && (!trace.graph->archive() || trace.graph->archive()->isEmpty());
+    double prev = empty ? -std::numeric_limits<double>::infinity() : trace.lastKey;
+    for (int i = 0; i < n; ++i) {
+        prev = std::max(prev, static_cast<double>(m_readTime.at(i) - m_timeOriginMs) / 1000.0);
+        m_readKeys[i] = prev;
+    }
+    trace.lastKey = prev;
+    if (keepSeries) {
+        trace.graph->append(m_readKeys.constData(), m_readValues.constData(), n);
+        trace.dirty = true;
+    } else {
+        trace.graph->appendToArchive(m_readKeys.constData(), m_readValues.constData(), n);
+        trace.stale = true;
+    }
+    const SampleArchive *archive = trace.graph->archive();
+    if (archive && archive->hasFailed()) reportArchiveFailure(trace);
+    return true;
+}
+
+bool WaveformView::latestKey(double &key) const
+{
+    bool found = false;
+    for (const auto &trace : m_traces) {
+        const WaveSeries &s = trace->graph->series();
+        if (!trace->visible || s.isEmpty()) continue;
+        key = found ? std::max(key, s.lastKey()) : s.lastKey();
+        found = true;
+    }
+    return found;
+}
+
+void WaveformView::followLatest()
+{
+    if (triggerActive()) {
+        if (!m_hasCapture) return;
+        m_plot->xAxis->setRange(m_captureLower, m_captureUpper);
+    } else {
+        double xmax = 0.0;
+        if (!latestKey(xmax)) return;
+        m_plot->xAxis->setRange(std::max(0.0, xmax - kViewSeconds), xmax);
+    }
+
+    // 各数值轴按当前横轴范围内可见通道的数据缩放
+    bool leftScaled = false;
+    bool rightScaled = false;
+    for (const auto &trace : m_traces) {
+        const bool empty = triggerActive() ? trace->capture->data()->isEmpty() : trace->graph->series().isEmpty();
+        if (!trace->visible || empty) continue;
+        bool &scaled = trace->rightAxis ? rightScaled : leftScaled;
+        if (triggerActive()) trace->capture->rescaleValueAxis(scaled, true);
+        else trace->graph->rescaleValueAxis(scaled, true);
+        scaled = true;
+    }
+}
+
+void WaveformView::updateHover()
+{
+    // 每条曲线按键二分查找最近样本，十字线吸附到其中离鼠标最近的一个
+    const double key = m_plot->xAxis->pixelToCoord(m_hoverPos.x());
+    QStringList lines;
+    bool snapped = false;
+    double snapKey = 0.0;
+    for (const auto &trace : m_traces) {
+        double k = 0.0;
+        double v = 0.0;
+        const bool found = trace->visible && nearestSample(*trace, key, k, v);
+        trace->marker->setVisible(found && std::isfinite(v));
+        if (!found) continue;
+        trace->marker->position->setCoords(k, v);
+        if (!snapped || std::abs(k - key) < std::abs(snapKey - key)) {
+            snapKey = k;
+            snapped = true;
+        }
+        lines << QStringLiteral("%1: %2").arg(trace->graph->name(), QString::number(v, 'f', 3));
+    }
+    m_crosshair->setVisible(snapped);
+    m_hoverLabel->setVisible(snapped);
+    if (!snapped) return;
+    m_crosshair->position->setCoords(snapKey, m_plot->yAxis->pixelToCoord(m_hoverPos.y()));
+    lines.prepend(QStringLiteral("t: %1 s").arg(QString::number(snapKey, 'f', 3)));
+    m_hoverLabel->setText(lines.join(QLatin1Char('\n')));
+}
+
+bool WaveformView::nearestSample(const Trace &trace, double key, double &outKey, double &outValue) const
+{
+    if (!triggerActive()) return trace.graph->nearestSample(key, outKey, outValue);
+    // 捕获窗口按键有序，二分查找两侧最近的点
+    const QSharedPointer<QCPGraphDataContainer> data = trace.capture->data();
+    if (data->isEmpty()) return false;
+    QCPGraphDataContainer::const_iterator it = data->findBegin(key, false);
+    if (it == data->constEnd() || (it != data->constBegin() && key - (it - 1)->key < it->key - key)) --it;
+    outKey = it->key;
+    outValue = it->value;
+    return true;
+}
+
+void WaveformView::hideHover()
+{
+    m_hoverActive = false;
+    m_hoverTimer->stop();
+    m_crosshair->setVisible(false);
+    m_hoverLabel->setVisible(false);
+    for (const auto &trace : m_traces) trace->marker->setVisible(false);
+    m_plot->layer(kHoverLayer)->replot();
+}
+
+bool WaveformView::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched != m_plot) return QWidget::eventFilter(watched, event);
+
+    if (event->type() == QEvent::MouseButtonPress) {
+        QMouseEvent *me = static_cast<QMouseEvent*>(event);
+        if (me->button() == Qt::LeftButton && !(me->modifiers() & (Qt::ControlModifier | Qt::ShiftModifier | Qt::AltModifier))) {
+            m_autoFollow = false;
+        }
+    } else if (event->type() == QEvent::MouseMove) {
+        // 只记录位置，同一帧内的多次移动合并为一次查询
+        m_hoverPos = static_cast<QMouseEvent*>(event)->pos();
+        m_hoverActive = true;
+        if (!m_hoverTimer->isActive()) m_hoverTimer->start();
+    } else if (event->type() == QEvent::Leave) {
+        hideHover();
+    } else if (event->type() == QEvent::MouseButtonRelease) {
+        if (m_autoFollow || triggerActive()) return false; // 触发模式下双击恢复跟随
+        double lastX = 0.0;
+        if (latestKey(lastX) && m_plot->xAxis->range().upper >= lastX - 1e-6) {
+            m_autoFollow = true;
+        }
+    }
+    return QWidget::eventFilter(watched, event);
+}
@@ -0,0 +1,167 @@
+#ifndef WAVEFORMVIEW_H
+#define WAVEFORMVIEW_H
+
+#include <QColor>
+#include <QElapsedTimer>
+#include <QPoint>
+#include <QPointer>
+#include <QString>
+#include <QVector>
+#include <QWidget>
+#include <memory>
+#include <vector>
+
+class ChannelRegistry;
+class QComboBox;
+class QCPGraph;
+class QCPItemStraightLine;
+class QCPItemText;
+class QCPItemTracer;
+class QCustomPlot;
+class QDoubleSpinBox;
+class QLabel;
+class QSpinBox;
+class QTableWidget;
+class QThread;
+class QTimer;
+class RenderScheduler;
+class WaveGraph;
+class WaveSeries;
+
+// 波形视图：注册表中每个通道一条曲线，颜色、坐标轴（左/右）和显示与否可逐通道设置。
+// 每条曲线记录自己读到的通道序号，注册表有新数据时只拉取新增样本，所以每批数据的开销只与新样本数有关。
+// 隐藏的通道照常拉取并写入历史文件，只跳过内存中的曲线缓冲和重绘，重新显示时从历史文件补回缓冲。
+// 拉取后只把通道标脏，跟随、悬停刷新和重绘由 RenderScheduler 按刷新周期合并进行。
+// 横轴为到达时间，均匀采样的通道不存逐点时间。
+// 每个通道保留数百万点的历史，缩放到任意范围都由 LOD 金字塔按像素宽度取数；
+// 全部历史同时写入会话目录下的逐通道列式文件，可回看更早的数据、导出和统计，退出时删除。
+// 触发模式下像示波器一样在选定通道上检测边沿：拉取时对新到的样本块做检测，
+// 凑齐触发后的样本才把触发点前后的窗口复制到捕获曲线并重绘，历史照常记录但不触发重绘。
+class WaveformView : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit WaveformView(QWidget *parent = nullptr);
+    ~WaveformView() override;
+
+    void setRegistry(ChannelRegistry *registry);
+    void setScheduler(RenderScheduler *scheduler); // 未设置时每次变化都排队重绘
+    void applyTheme(bool dark);
+
+    static constexpr int kMaxPoints = 1 << 22;  // 每个通道保留的历史点数（1 kHz 约 70 分钟），按需增长
+    static constexpr double kViewSeconds = 10.0;     // 自动跟随时只看最近10秒，避免挤在一起
+    static constexpr double kUniformTolerance = 0.05; // 到达时间偏离均匀直线不超过 50 ms 即按均匀采样存储（串口按批读取，同批样本时间相同）
+    static constexpr int kMaxTriggerDepth = kMaxPoints / 4; // 触发前/后深度上限（样本数）
+    static constexpr int kAutoTriggerMs = 500;              // 自动模式下超过该时间未触发即强制采集一次
+
+    enum TriggerMode { FreeRun, AutoTrigger, NormalTrigger, SingleTrigger };
+    enum TriggerEdge { RisingEdge, FallingEdge, AnyEdge };
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void syncChannels();
+    void clearTraces();
+    void ingest();
+    void onCellChanged(int row, int column);
+    void onCellDoubleClicked(int row, int column);
+    void exportHistory();
+    void showStatistics();
+    void applyTriggerSettings();
+    void armTrigger();
+
+private:
+    struct Trace {
+        int channel = -1;
+        WaveGraph* graph = nullptr; // 由 m_plot 持有，数据就地存放在其环形缓冲中
+        QCPItemTracer* marker = nullptr; // 悬停时标出该通道最近的样本
+        QCPGraph* capture = nullptr;     // 触发模式下显示的捕获窗口，键为相对触发点的秒数
+        quint64 seq = 0;     // 下一次从通道读取的序号
+        QColor color;
+        bool rightAxis = false;
+        bool visible = true;
+        bool dirty = false;  // 上一帧之后有新样本
+        bool stale = false;  // 隐藏期间只写了历史文件，内存中的曲线缓冲需要重建
+        double lastKey = 0.0; // 最后写入的键，隐藏时曲线缓冲不更新，键的单调性以此为准
+    };
+
+    struct Trigger {
+        TriggerMode mode = FreeRun;
+        int channel = 0;
+        TriggerEdge edge = RisingEdge;
+        double level = 0.0;
+        int pre = 500;         // 触发点之前的样本数（触发通道）
+        int post = 500;        // 触发点之后的样本数
+        bool armed = false;    // 单次模式采集一次后解除，需重新准备
+        bool pending = false;  // 已找到触发点，等待触发后的样本
+        quint64 at = 0;        // 触发样本在通道中的序号
+        quint64 scanFrom = 0;  // 下一个要检测的样本序号
+        int captures = 0;
+        QElapsedTimer sinceCapture;
+    };
+
+    void setTraceColor(Trace &trace, const QColor &color);
+    void setTraceAxis(Trace &trace, bool right);
+    void applyTraceVisibility(Trace &trace);
+    bool pullTrace(Trace &trace);
+    bool needsSeries(const Trace &trace) const; // 是否要维护内存中的曲线缓冲（显示或作触发源）
+    void reportArchiveFailure(const Trace &trace); // 历史文件写入失败时提示一次
+    bool latestKey(double &key) const; // 可见通道中最新样本的键
+    void followLatest();
+    void scheduleReplot(); // 视图设置改变（颜色、坐标轴、主题等），下一帧重绘
+    void requestFrame();
+    bool prepareFrame();   // 每帧重绘前调用，返回 false 表示没有变化
+    void updateHover(); // 按最近一次鼠标位置刷新十字线和读数
+    void hideHover();
+    bool nearestSample(const Trace &trace, double key, double &outKey, double &outValue) const;
+    bool triggerActive() const { return m_trigger.mode != FreeRun; }
+    bool processTrigger(); // 返回 true 表示有新的捕获窗口
+    bool findTrigger(const WaveSeries &series, quint64 base, quint64 end);
+    void captureWindow(quint64 at, const WaveSeries &series, quint64 base);
+    void updateTriggerLevelLine();
+    void updateTriggerStatus();
+
+    ChannelRegistry* m_registry = nullptr;
+    RenderScheduler* m_scheduler = nullptr;
+    bool m_viewDirty = false;
+    QCustomPlot* m_plot = nullptr;
+    QTableWidget* m_table = nullptr;
+    QString m_archiveDir;            // 本次会话的历史文件目录
+    QPointer<QThread> m_exportThread; // 正在进行的导出
+    bool m_archiveWarned = false;     // 已提示过历史文件写入失败
+    std::vector<std::unique_ptr<Trace>> m_traces; // 与通道序号一一对应
+    bool m_autoFollow = true;
+    qint64 m_timeOriginMs = 0; // 时间轴零点：清空后首个读到的样本时间
+    bool m_hasTimeOrigin = false;
+
+    // 悬停读数：鼠标移动只记录位置，每帧至多查询一次，画在单独缓冲的 overlay 层上
+    QTimer* m_hoverTimer = nullptr;
+    QPoint m_hoverPos;
+    bool m_hoverActive = false;
+    QCPItemTracer* m_crosshair = nullptr;
+    QCPItemText* m_hoverLabel = nullptr;
+
+    // 触发
+    Trigger m_trigger;
+    QComboBox* m_modeBox = nullptr;
+    QComboBox* m_triggerChannelBox = nullptr;
+    QComboBox* m_edgeBox = nullptr;
+    QDoubleSpinBox* m_levelBox = nullptr;
+    QSpinBox* m_preBox = nullptr;
+    QSpinBox* m_postBox = nullptr;
+    QLabel* m_triggerStatus = nullptr;
+    QCPItemStraightLine* m_levelLine = nullptr; // 触发电平
+    QCPItemStraightLine* m_zeroLine = nullptr;  // 触发时刻
+    bool m_hasCapture = false;
+    bool m_captureDirty = false;
+    double m_captureLower = 0.0; // 捕获窗口的键范围（相对触发点）
+    double m_captureUpper = 0.0;
+
+    // 拉取用的复用缓冲
+    QVector<qint64> m_readTime;
+    QVector<double> m_readValues;
+    QVector<double> m_readKeys;
+};
+
+#endif // WAVEFORMVIEW_H
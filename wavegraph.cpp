@@ -0,0 +1,356 @@
+#include "wavegraph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// 按像素列合并输出折线：每列依次输出首值、最小值、最大值、末值，竖线覆盖该列的全部取值；
+// 稀疏时每列只有一个点，等同于逐点连线。键须按升序送入。
+class WaveGraph::ColumnBinner
+{
+public:
+    ColumnBinner(const QCPAbstractPlottable *graph, QCPAxis *keyAxis, QCPPainter *painter, QVector<QPointF> &lines)
+        : m_graph(graph), m_keyAxis(keyAxis), m_painter(painter), m_lines(lines)
+    {
+        m_lines.clear();
+    }
+
+    // 一段样本：首键、首末值与最值
+    void add(double key, double first, double last, double mn, double mx)
+    {
+        const int c = static_cast<int>(m_keyAxis->coordToPixel(key));
+        if (m_open && c == m_column) {
+            m_min = std::min(m_min, mn);
+            m_max = std::max(m_max, mx);
+            m_last = last;
+            return;
+        }
+        emitColumn();
+        m_open = true;
+        m_column = c;
+        m_key = key;
+        m_first = first;
+        m_min = mn;
+        m_max = mx;
+        m_last = last;
+    }
+
+    // NaN 处断开折线
+    void gap()
+    {
+        emitColumn();
+        flush();
+    }
+
+    void finish() { gap(); }
+
+private:
+    void emitColumn()
+    {
+        if (!m_open) return;
+        m_open = false;
+        m_lines.append(m_graph->coordsToPixels(m_key, m_first));
+        if (m_min == m_max) return;
+        m_lines.append(m_graph->coordsToPixels(m_key, m_min));
+        m_lines.append(m_graph->coordsToPixels(m_key, m_max));
+        m_lines.append(m_graph->coordsToPixels(m_key, m_last));
+    }
+
+    void flush()
+    {
+        if (m_lines.size() >= 2) m_painter->drawPolyline(m_lines.constData(), static_cast<int>(m_lines.size()));
+        m_lines.clear();
+    }
+
+    const QCPAbstractPlottable *m_graph;
+    QCPAxis *m_keyAxis;
+    QCPPainter *m_painter;
+    QVector<QPointF> &m_lines;
+    bool m_open = false;
+    int m_column = 0;
+    double m_key = 0.0;
+    double m_first = 0.0, m_min = 0.0, m_max = 0.0, m_last = 0.0;
+};
+
+WaveGraph::WaveGraph(QCPAxis *keyAxis, QCPAxis *valueAxis, int capacity)
+    : QCPAbstractPlottable(keyAxis, valueAxis)
+    , m_series(capacity)
+{
+    setSelectable(QCP::stNone);
+}
+
+WaveGraph::~WaveGraph() = default;
+
+void WaveGraph::setArchive(std::unique_ptr<SampleArchive> archive)
+{
+    m_archive = std::move(archive);
+}
+
+void WaveGraph::append(const double *keys, const double *values, int count)
+{
+    m_series.append(keys, values, count);
+    if (m_archive) m_archive->append(keys, values, count);
+}
+
+void WaveGraph::appendToArchive(const double *keys, const double *values, int count)
+{
+    if (m_archive) m_archive->append(keys, values, count);
+}
+
+void WaveGraph::reloadFromArchive(int count)
+{
+    m_series.clear();
+    if (!m_archive || count <= 0) return;
+    const int tail = m_archive->tailCount();
+    const int blocks = std::min(m_archive->blockCount(),
+                                (std::max(0, count - tail) + SampleArchive::kBlockSamples - 1) / SampleArchive::kBlockSamples);
+    // 从所需的第一块开始按块追加，跳过第一块中多出的样本
+    int skip = std::max(0, blocks * SampleArchive::kBlockSamples + tail - count);
+    SampleArchive::BlockView view;
+    for (int b = m_archive->blockCount() - blocks; b < m_archive->blockCount(); ++b) {
+        const int from = std::min(skip, SampleArchive::kBlockSamples);
+        skip -= from;
+        if (m_archive->block(b, view)) {
+            m_series.append(view.keys + from, view.values + from, SampleArchive::kBlockSamples - from);
+        }
+    }
+    const int from = std::min(skip, tail);
+    m_series.append(m_archive->tailKeys() + from, m_archive->tailValues() + from, tail - from);
+}
+
+void WaveGraph::clear()
+{
+    m_series.clear();
+    if (m_archive) m_archive->clear();
+}
+
+bool WaveGraph::nearestSample(double key, double &outKey, double &outValue) const
+{
+    bool found = false;
+    auto consider = [&](double k, double v) {
+        if (!found || std::abs(k - key) < std::abs(outKey - key)) {
+            outKey = k;
+            outValue = v;
+            found = true;
+        }
+    };
+    const int n = m_series.size();
+    if (n > 0) {
+        const int idx = m_series.lowerBound(key);
+        if (idx < n) consider(m_series.keyAt(idx), m_series.valueAt(idx));
+        if (idx > 0) consider(m_series.keyAt(idx - 1), m_series.valueAt(idx - 1));
+    }
+    const double ramFirst = archiveEnd();
+    if (m_archive && m_archive->blockCount() > 0 && key < ramFirst) {
+        // 相邻候选：目标块内的上下界，或前一块的末样本（摘要中已有，无需页入）
+        const int b = m_archive->findBlock(key);
+        if (b > 0) {
+            const SampleArchive::BlockSummary &prev = m_archive->summary(b - 1);
+            consider(prev.lastKey, prev.lastValue);
+        }
+        SampleArchive::BlockView view;
+        if (b < m_archive->blockCount() && m_archive->block(b, view)) {
+            const double *end = view.keys + SampleArchive::kBlockSamples;
+            const int i = static_cast<int>(std::lower_bound(view.keys, end, key) - view.keys);
+            if (i < SampleArchive::kBlockSamples && view.keys[i] < ramFirst) consider(view.keys[i], view.values[i]);
+            if (i > 0) consider(view.keys[i - 1], view.values[i - 1]);
+        }
+    }
+    return found;
+}
+
+double WaveGraph::archiveEnd() const
+{
+    // 环形缓冲中仍有的样本从内存绘制，更早的从磁盘绘制
+    return m_series.isEmpty() ? std::numeric_limits<double>::infinity() : m_series.firstKey();
+}
+
+void WaveGraph::visibleSpan(int &begin, int &end) const
+{
+    const QCPRange range = mKeyAxis->range();
+    begin = std::max(0, m_series.lowerBound(range.lower) - 1);
+    end = std::min(m_series.size(), m_series.upperBound(range.upper) + 1);
+}
+
+void WaveGraph::draw(QCPPainter *painter)
+{
+    QCPAxis *keyAxis = mKeyAxis.data();
+    if (!keyAxis || !mValueAxis) return;
+    if (keyAxis->range().size() <= 0) return;
+    if (mPen.style() == Qt::NoPen || mPen.color().alpha() == 0) return;
+    const bool hasArchive = m_archive && m_archive->blockCount() > 0;
+    if (m_series.isEmpty() && !hasArchive) return;
+
+    painter->setPen(mPen);
+    painter->setBrush(Qt::NoBrush);
+    applyDefaultAntialiasingHint(painter);
+    ColumnBinner bin(this, keyAxis, painter, m_lines);
+
+    const QCPRange range = keyAxis->range();
+    if (hasArchive && range.lower < archiveEnd()) drawArchive(bin, range.lower, std::min(range.upper, archiveEnd()));
+
+    int begin = 0;
+    int end = 0;
+    if (!m_series.isEmpty()) visibleSpan(begin, end);
+    if (begin < end) {
+        // 可见样本远多于像素时从 LOD 金字塔取桶，遍历量只与像素宽度有关
+        const double pixelSpan = std::abs(keyAxis->coordToPixel(m_series.keyAt(end - 1)) - keyAxis->coordToPixel(m_series.keyAt(begin)));
+        const int level = m_series.levelFor(end - begin, static_cast<int>(2 * pixelSpan) + 2);
+        m_series.forEachSpan(begin, end, level, [&](int i, int j, double mn, double mx) {
+            if (std::isnan(mn)) { // 原始样本为 NaN
+                bin.gap();
+                return;
+            }
+            if (mn > mx) return; // 整桶都是 NaN
+            double fv = m_series.valueAt(i);
+            double lv = m_series.valueAt(j);
+            if (std::isnan(fv)) fv = mn;
+            if (std::isnan(lv)) lv = mx;
+            bin.add(m_series.keyAt(i), fv, lv, mn, mx);
+        });
+    }
+    bin.finish();
+}
+
+void WaveGraph::drawArchive(ColumnBinner &bin, double lower, double upper)
+{
+    // 每块按其屏幕宽度选择精度：不足两个像素只用摘要，不足子桶数两倍用子桶，否则逐点；
+    // 只有后两种需要页入块
+    QCPAxis *keyAxis = mKeyAxis.data();
+    const double ramFirst = archiveEnd();
+    for (int b = m_archive->findBlock(lower); b < m_archive->blockCount(); ++b) {
+        const SampleArchive::BlockSummary &s = m_archive->summary(b);
+        if (s.firstKey > upper || s.firstKey >= ramFirst) break;
+        const double px = std::abs(keyAxis->coordToPixel(s.lastKey) - keyAxis->coordToPixel(s.firstKey));
+        const bool boundary = s.lastKey >= ramFirst; // 与内存部分重叠的块逐点绘制到重叠处为止
+        if (!boundary && px < 2.0) {
+            if (s.min <= s.max) {
+                bin.add(s.firstKey, std::isnan(s.firstValue) ? s.min : s.firstValue,
+                        std::isnan(s.lastValue) ? s.max : s.lastValue, s.min, s.max);
+            }
+            continue;
+        }
+        SampleArchive::BlockView view;
+        if (!m_archive->block(b, view)) break;
+        if (!boundary && px < 2.0 * SampleArchive::kSubBuckets) {
+            for (int k = 0; k < SampleArchive::kSubBuckets; ++k) {
+                const double mn = view.subMin[k];
+                const double mx = view.subMax[k];
+                if (mn > mx) continue;
+                const int i = k * SampleArchive::kSubSamples;
+                double fv = view.values[i];
+                double lv = view.values[i + SampleArchive::kSubSamples - 1];
+                if (std::isnan(fv)) fv = mn;
+                if (std::isnan(lv)) lv = mx;
+                bin.add(view.keys[i], fv, lv, mn, mx);
+            }
+            continue;
+        }
+        for (int i = 0; i < SampleArchive::kBlockSamples; ++i) {
+            const double k = view.keys[i];
+            if (k >= ramFirst) break;
+            const double v = view.values[i];
+            if (std::isnan(v)) bin.gap();
+            else bin.add(k, v, v, v, v);
+        }
+    }
+}
+
+void WaveGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
+{
+    applyDefaultAntialiasingHint(painter);
+    painter->setPen(mPen);
+    painter->drawLine(QLineF(rect.left(), rect.top() + rect.height() / 2.0, rect.right() + 5, rect.top() + rect.height() / 2.0));
+}
+
+double WaveGraph::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
+{
+    if ((onlySelectable && mSelectable == QCP::stNone) || m_series.isEmpty()) return -1;
+    if (!mKeyAxis || !mValueAxis) return -1;
+    if (!mKeyAxis->axisRect()->rect().contains(pos.toPoint())) return -1;
+
+    double key = 0.0;
+    double value = 0.0;
+    pixelsToCoords(pos, key, value);
+    const int idx = m_series.lowerBound(key);
+    double best = -1;
+    int bestIdx = -1;
+    for (int i = std::max(0, idx - 1); i <= std::min(m_series.size() - 1, idx); ++i) {
+        const QPointF p = coordsToPixels(m_series.keyAt(i), m_series.valueAt(i));
+        const double dist = QCPVector2D(p - pos).length();
+        if (bestIdx < 0 || dist < best) {
+            best = dist;
+            bestIdx = i;
+        }
+    }
+    if (details && bestIdx >= 0) details->setValue(QCPDataSelection(QCPDataRange(bestIdx, bestIdx + 1)));
+    return best;
+}
+
+QCPRange WaveGraph::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
+{
+    foundRange = false;
+    int begin = 0;
+    int end = m_series.size();
+    if (inSignDomain == QCP::sdPositive) begin = m_series.upperBound(0.0);
+    else if (inSignDomain == QCP::sdNegative) end = m_series.lowerBound(0.0);
+    if (begin >= end) return QCPRange();
+    foundRange = true;
+    QCPRange range(m_series.keyAt(begin), m_series.keyAt(end - 1));
+    if (m_archive && m_archive->blockCount() > 0 && inSignDomain == QCP::sdBoth) {
+        range.lower = std::min(range.lower, m_archive->firstKey());
+    }
+    return range;
+}
+
+QCPRange WaveGraph::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
+{
+    foundRange = false;
+    int begin = 0;
+    int end = m_series.size();
+    const bool restrictKeys = inKeyRange != QCPRange();
+    if (restrictKeys) {
+        begin = m_series.lowerBound(inKeyRange.lower);
+        end = m_series.upperBound(inKeyRange.upper);
+    }
+    double lo = 0.0;
+    double hi = 0.0;
+    auto take = [&](double v) {
+        if (inSignDomain == QCP::sdPositive && v <= 0) return;
+        if (inSignDomain == QCP::sdNegative && v >= 0) return;
+        if (!foundRange) {
+            lo = hi = v;
+            foundRange = true;
+        } else {
+            lo = std::min(lo, v);
+            hi = std::max(hi, v);
+        }
+    };
+    if (inSignDomain == QCP::sdBoth) {
+        // 只需整体最值时直接用 LOD 桶，长区间也只遍历有限个桶
+        m_series.forEachSpan(begin, end, m_series.levelFor(end - begin, kRangeBuckets), [&](int, int, double mn, double mx) {
+            if (std::isnan(mn) || mn > mx) return;
+            take(mn);
+            take(mx);
+        });
+        // 内存之前的部分按块摘要估计
+        if (m_archive) {
+            const double ramFirst = archiveEnd();
+            const double lower = restrictKeys ? inKeyRange.lower : -std::numeric_limits<double>::infinity();
+            const double upper = restrictKeys ? inKeyRange.upper : std::numeric_limits<double>::infinity();
+            for (int b = m_archive->findBlock(lower); b < m_archive->blockCount(); ++b) {
+                const SampleArchive::BlockSummary &s = m_archive->summary(b);
+                if (s.firstKey > upper || s.firstKey >= ramFirst) break;
+                if (s.min > s.max) continue;
+                take(s.min);
+                take(s.max);
+            }
+        }
+    } else {
+        for (int i = begin; i < end; ++i) {
+            const double v = m_series.valueAt(i);
+            if (!std::isnan(v)) take(v);
+        }
+    }
+    return QCPRange(lo, hi);
+}
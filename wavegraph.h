@@ -0,0 +1,62 @@
+#ifndef WAVEGRAPH_H
+#define WAVEGRAPH_H
+
+#include <QVector>
+#include <memory>
+#include "qcustomplot/qcustomplot.h"
+#include "samplearchive.h"
+#include "waveseries.h"
+
+// 直接以 WaveSeries 环形缓冲为数据容器的曲线。
+// QCPGraph 的数据容器是连续数组，每次整体 set 都要复制整个窗口；这里追加和丢弃旧点
+// 都在环形缓冲上原地完成，绘制与求取数值范围时二分定位可见区间并就地遍历，
+// 可见点数超过像素列数两倍时按像素列合并为最小/最大值（与 QCPGraph 的自适应采样一致），
+// 数据量很大时从 WaveSeries 的 LOD 金字塔取桶，绘制开销只与像素宽度有关。
+// 可选的 SampleArchive 记录全部历史：早于环形缓冲的部分从磁盘块绘制，只页入视图需要的块。
+class WaveGraph : public QCPAbstractPlottable
+{
+    Q_OBJECT
+public:
+    WaveGraph(QCPAxis *keyAxis, QCPAxis *valueAxis, int capacity);
+    ~WaveGraph() override;
+
+    const WaveSeries &series() const { return m_series; }
+    void setUniformTolerance(double tolerance) { m_series.setUniformTolerance(tolerance); }
+    SampleArchive *archive() const { return m_archive.get(); }
+    void setArchive(std::unique_ptr<SampleArchive> archive);
+
+    // 同时写入环形缓冲和磁盘存储
+    void append(const double *keys, const double *values, int count);
+    // 只写磁盘存储（曲线隐藏时），环形缓冲随后需由 reloadFromArchive 重建
+    void appendToArchive(const double *keys, const double *values, int count);
+    // 用磁盘存储中最后 count 个样本重建环形缓冲，没有磁盘存储时只清空
+    void reloadFromArchive(int count);
+    void clear();
+
+    // 键最接近 key 的样本，内存中二分查找，更早的部分经块摘要定位后在块内二分，O(log n)
+    bool nearestSample(double key, double &outKey, double &outValue) const;
+
+    double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details = nullptr) const override;
+    QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth) const override;
+    QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth,
+                           const QCPRange &inKeyRange = QCPRange()) const override;
+
+protected:
+    void draw(QCPPainter *painter) override;
+    void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const override;
+
+private:
+    class ColumnBinner;
+
+    static constexpr int kRangeBuckets = 4096; // 求数值范围时最多合并到的桶数量级
+
+    void visibleSpan(int &begin, int &end) const; // 可见区间左右各多取一个点，线段延伸到视图外
+    double archiveEnd() const;
+    void drawArchive(ColumnBinner &bin, double lower, double upper);
+
+    WaveSeries m_series;
+    std::unique_ptr<SampleArchive> m_archive;
+    QVector<QPointF> m_lines; // 绘制用的复用缓冲
+};
+
+#endif // WAVEGRAPH_H
@@ -0,0 +1,203 @@
+#include "waveseries.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+WaveSeries::WaveSeries(int capacity)
+    : m_capacity(std::max(1, capacity))
+{
+    for (int l = 1; span(l) < static_cast<std::uint64_t>(m_capacity); ++l) {
+        Level lv;
+        lv.capacity = static_cast<std::uint64_t>(m_capacity) / span(l) + 2;
+        m_levels.push_back(lv);
+    }
+}
+
+void WaveSeries::append(const double *keys, const double *values, int count)
+{
+    if (count <= 0) return;
+    if (count > m_capacity) {
+        keys += count - m_capacity;
+        values += count - m_capacity;
+        count = m_capacity;
+    }
+    if (m_total == 0) m_keyMode = m_tolerance > 0 ? KeyMode::Probing : KeyMode::Explicit;
+    if (m_keyMode == KeyMode::Implicit && !fitsLine(keys, count)) materializeKeys();
+    const bool storeKeys = m_keyMode != KeyMode::Implicit;
+    const std::uint64_t firstAbs = m_total;
+
+    // 首次填满之前按需增长，此时最旧样本总在位置 0
+    int done = 0;
+    if (static_cast<int>(m_values.size()) < m_capacity) {
+        done = std::min(count, m_capacity - static_cast<int>(m_values.size()));
+        if (storeKeys) m_keys.insert(m_keys.end(), keys, keys + done);
+        m_values.insert(m_values.end(), values, values + done);
+        m_size += done;
+    }
+    if (done < count) {
+        // 写入位置紧接最新样本，最多分两段复制
+        const int rest = count - done;
+        const int tail = slot(m_size);
+        const int first = std::min(rest, m_capacity - tail);
+        if (storeKeys) {
+            std::copy(keys + done, keys + done + first, m_keys.begin() + tail);
+            std::copy(keys + done + first, keys + count, m_keys.begin());
+        }
+        std::copy(values + done, values + done + first, m_values.begin() + tail);
+        std::copy(values + done + first, values + count, m_values.begin());
+
+        const int overflow = m_size + rest - m_capacity;
+        if (overflow > 0) {
+            m_head = slot(overflow);
+            m_size = m_capacity;
+        } else {
+            m_size += rest;
+        }
+    }
+    m_total += static_cast<std::uint64_t>(count);
+    updateLevels(firstAbs, values, count);
+    if (m_keyMode == KeyMode::Probing && m_total >= static_cast<std::uint64_t>(kProbeSamples)) detectUniform();
+}
+
+bool WaveSeries::fitsLine(const double *keys, int count) const
+{
+    for (int i = 0; i < count; ++i) {
+        const double expected = m_t0 + static_cast<double>(m_total + static_cast<std::uint64_t>(i)) * m_dt;
+        if (!(std::abs(keys[i] - expected) <= m_tolerance)) return false;
+    }
+    return true;
+}
+
+void WaveSeries::detectUniform()
+{
+    // 只判断一次：用首末样本定出直线，所有样本都在容差内才算均匀
+    m_keyMode = KeyMode::Explicit;
+    if (m_size != static_cast<int>(m_total) || m_size < 2) return; // 已有样本被丢弃，序号与时间对不上
+    const double t0 = keyAt(0);
+    const double dt = (keyAt(m_size - 1) - t0) / static_cast<double>(m_size - 1);
+    if (!(dt > 0)) return;
+    for (int i = 0; i < m_size; ++i) {
+        if (!(std::abs(keyAt(i) - (t0 + static_cast<double>(i) * dt)) <= m_tolerance)) return;
+    }
+    m_t0 = t0;
+    m_dt = dt;
+    m_keyMode = KeyMode::Implicit;
+    std::vector<double>().swap(m_keys);
+}
+
+void WaveSeries::materializeKeys()
+{
+    // 按直线补回现存样本的键，存储布局与数值列一致
+    std::vector<double> keys(m_values.size());
+    for (int i = 0; i < m_size; ++i) keys[static_cast<std::size_t>(slot(i))] = keyAt(i);
+    m_keys.swap(keys);
+    m_keyMode = KeyMode::Explicit;
+}
+
+void WaveSeries::setBucket(Level &lv, std::uint64_t bucket, double mn, double mx)
+{
+    // 桶按序号依次出现，未填满时新桶正好落在末尾
+    const std::size_t s = static_cast<std::size_t>(bucket % lv.capacity);
+    if (s == lv.min.size()) {
+        lv.min.push_back(mn);
+        lv.max.push_back(mx);
+    } else {
+        lv.min[s] = mn;
+        lv.max[s] = mx;
+    }
+}
+
+void WaveSeries::updateLevels(std::uint64_t firstAbs, const double *values, int count)
+{
+    if (m_levels.empty()) return;
+    constexpr double inf = std::numeric_limits<double>::infinity();
+
+    // 第 1 层直接由新样本更新，NaN 不参与最值
+    Level &base = m_levels.front();
+    for (int i = 0; i < count; ++i) {
+        const std::uint64_t a = firstAbs + static_cast<std::uint64_t>(i);
+        const double v = values[i];
+        const bool valid = !std::isnan(v);
+        if ((a & (kFan - 1)) == 0) {
+            setBucket(base, a >> kShift, valid ? v : inf, valid ? v : -inf);
+        } else if (valid) {
+            const std::size_t s = static_cast<std::size_t>((a >> kShift) % base.capacity);
+            if (v < base.min[s]) base.min[s] = v;
+            if (v > base.max[s]) base.max[s] = v;
+        }
+    }
+
+    // 上层只重算被触及的桶，每个由至多 8 个下层桶合并
+    std::uint64_t lo = firstAbs >> kShift;
+    std::uint64_t hi = (firstAbs + static_cast<std::uint64_t>(count) - 1) >> kShift;
+    for (std::size_t l = 1; l < m_levels.size(); ++l) {
+        const Level &child = m_levels[l - 1];
+        Level &parent = m_levels[l];
+        const std::uint64_t plo = lo >> kShift;
+        const std::uint64_t phi = hi >> kShift;
+        for (std::uint64_t p = plo; p <= phi; ++p) {
+            const std::uint64_t c0 = p << kShift;
+            const std::uint64_t c1 = std::min(c0 + kFan - 1, hi);
+            double mn = inf;
+            double mx = -inf;
+            for (std::uint64_t c = c0; c <= c1; ++c) {
+                const std::size_t s = static_cast<std::size_t>(c % child.capacity);
+                mn = std::min(mn, child.min[s]);
+                mx = std::max(mx, child.max[s]);
+            }
+            setBucket(parent, p, mn, mx);
+        }
+        lo = plo;
+        hi = phi;
+    }
+}
+
+void WaveSeries::clear()
+{
+    m_keys.clear();
+    m_values.clear();
+    m_head = 0;
+    m_size = 0;
+    m_total = 0;
+    m_keyMode = KeyMode::Explicit;
+    for (Level &lv : m_levels) {
+        lv.min.clear();
+        lv.max.clear();
+    }
+}
+
+int WaveSeries::lowerBound(double key) const
+{
+    int lo = 0;
+    int hi = m_size;
+    while (lo < hi) {
+        const int mid = lo + (hi - lo) / 2;
+        if (keyAt(mid) < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+int WaveSeries::upperBound(double key) const
+{
+    int lo = 0;
+    int hi = m_size;
+    while (lo < hi) {
+        const int mid = lo + (hi - lo) / 2;
+        if (keyAt(mid) <= key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+int WaveSeries::levelFor(int count, int items) const
+{
+    if (items <= 0) return 0;
+    int l = 0;
+    while (l < static_cast<int>(m_levels.size())
+           && (static_cast<std::uint64_t>(count) >> (kShift * (l + 1))) >= static_cast<std::uint64_t>(items)) {
+        ++l;
+    }
+    return l;
+}
@@ -0,0 +1,122 @@
+#ifndef WAVESERIES_H
+#define WAVESERIES_H
+
+#include <cstdint>
+#include <vector>
+
+// 单个波形通道的显示缓存：键、值分开存放的环形缓冲（结构数组）。
+// 追加只写入新样本，满后覆盖最旧的样本，代价与新样本数成正比；
+// 读取按逻辑序号，0 为最旧的样本，键单调不减。存储在首次填满前按需增长。
+//
+// 同时维护最小/最大值金字塔（LOD）：第 l 层每个桶汇总 8^l 个连续样本的最小/最大值，
+// 追加时只更新被新样本触及的桶。任意缩放下绘制只需按像素宽度取若干个桶，
+// 与可见样本数无关。
+//
+// 设置了均匀容差时，先以显式键写入前 kProbeSamples 个样本，若它们都落在直线 t0 + i·dt
+// 的容差内，就改为隐式键：不再存储逐点键，内存减半。之后有样本偏离直线（断流、速率变化）
+// 时把现存样本的键按直线补回，转为显式键，直到 clear()。
+class WaveSeries
+{
+public:
+    explicit WaveSeries(int capacity);
+
+    int capacity() const { return m_capacity; }
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    // 键与直线的最大允许偏差，<= 0 时始终存储显式键；在 clear() 后的首次写入前设置
+    void setUniformTolerance(double tolerance) { m_tolerance = tolerance; }
+    bool isImplicit() const { return m_keyMode == KeyMode::Implicit; }
+
+    // 超过容量时只保留最后 capacity 个样本
+    void append(const double *keys, const double *values, int count);
+    void clear();
+
+    double keyAt(int i) const
+    {
+        if (m_keyMode == KeyMode::Implicit) return m_t0 + static_cast<double>(m_total - static_cast<std::uint64_t>(m_size) + static_cast<std::uint64_t>(i)) * m_dt;
+        return m_keys[slot(i)];
+    }
+    double valueAt(int i) const { return m_values[slot(i)]; }
+    double firstKey() const { return keyAt(0); }
+    double lastKey() const { return keyAt(m_size - 1); }
+
+    // 二分查找：第一个键 >= key / > key 的逻辑序号，找不到时返回 size()
+    int lowerBound(double key) const;
+    int upperBound(double key) const;
+
+    // 使 count 个样本至少合并成 items 个桶的最粗一层，0 表示原始样本
+    int levelFor(int count, int items) const;
+
+    // 遍历逻辑区间 [begin, end)：对齐处尽量使用不超过 level 层的最粗桶，边缘逐层细化。
+    // 回调 f(first, last, min, max)，first/last 为该段首末样本的逻辑序号（含）；
+    // 原始样本为 NaN 时 min/max 也为 NaN，全为 NaN 的桶 min > max。
+    template <typename F>
+    void forEachSpan(int begin, int end, int level, F &&f) const
+    {
+        const std::uint64_t base = m_total - static_cast<std::uint64_t>(m_size); // 逻辑序号 0 的绝对序号
+        std::uint64_t a = base + static_cast<std::uint64_t>(begin);
+        const std::uint64_t stop = base + static_cast<std::uint64_t>(end);
+        while (a < stop) {
+            int l = level;
+            while (l > 0 && ((a & (span(l) - 1)) != 0 || a + span(l) > stop)) --l;
+            const int i = static_cast<int>(a - base);
+            if (l == 0) {
+                const double v = valueAt(i);
+                f(i, i, v, v);
+                ++a;
+            } else {
+                const Level &lv = m_levels[static_cast<std::size_t>(l - 1)];
+                const std::size_t s = static_cast<std::size_t>((a >> (kShift * l)) % lv.capacity);
+                f(i, i + static_cast<int>(span(l)) - 1, lv.min[s], lv.max[s]);
+                a += span(l);
+            }
+        }
+    }
+
+private:
+    static constexpr int kShift = 3; // 每层合并 8 个下层桶
+    static constexpr int kProbeSamples = 4096; // 判断是否均匀采样所用的样本数
+
+    enum class KeyMode {
+        Probing,  // 显式存储，样本数够后判断是否均匀
+        Implicit, // 键 = m_t0 + 绝对序号 · m_dt
+        Explicit,
+    };
+    static constexpr std::uint64_t kFan = std::uint64_t(1) << kShift;
+
+    struct Level {
+        std::uint64_t capacity = 0; // 桶数，覆盖整个环形缓冲再留余量
+        std::vector<double> min;
+        std::vector<double> max;
+    };
+
+    static std::uint64_t span(int level) { return std::uint64_t(1) << (kShift * level); }
+    static void setBucket(Level &lv, std::uint64_t bucket, double mn, double mx);
+
+    int slot(int i) const
+    {
+        const int s = m_head + i;
+        return s < m_capacity ? s : s - m_capacity;
+    }
+
+    void updateLevels(std::uint64_t firstAbs, const double *values, int count);
+    bool fitsLine(const double *keys, int count) const; // 新样本是否仍在隐式键直线的容差内
+    void detectUniform();
+    void materializeKeys();
+
+    const int m_capacity;
+    std::vector<double> m_keys;
+    std::vector<double> m_values;
+    int m_head = 0; // 最旧样本所在位置
+    int m_size = 0;
+    std::uint64_t m_total = 0; // 已写入的样本总数，即下一个样本的绝对序号
+    std::vector<Level> m_levels;
+
+    double m_tolerance = 0.0;
+    KeyMode m_keyMode = KeyMode::Explicit;
+    double m_t0 = 0.0; // 绝对序号 0 的键
+    double m_dt = 0.0;
+};
+
+#endif // WAVESERIES_H